@@ -1,11 +1,14 @@
 #ifndef CELL_H
 #define CELL_H
 
+#include "shape/Renderable.h"
+
+#include <algorithm>
 #include <memory>
 #include <vector>
 
-class Renderable;
 class Portal;
+class Skybox;
 
 class Cell {
 public:
@@ -21,11 +24,47 @@ public:
   const std::vector<std::shared_ptr<Renderable>> &getGeometry() const {
     return geometry;
   }
-  std::vector<std::shared_ptr<Renderable>> &getGeometry() { return geometry; }
+
+  void add(std::shared_ptr<Renderable> g) {
+    geometry.push_back(std::move(g));
+    ++edits;
+  }
+  void remove(const Renderable *g) {
+    geometry.erase(std::remove_if(geometry.begin(), geometry.end(),
+                                  [g](auto &h) { return h.get() == g; }),
+                   geometry.end());
+    statics.erase(std::remove(statics.begin(), statics.end(), g),
+                  statics.end());
+    ++edits;
+  }
+
+  /// geometry that never changes once added: the renderer may compile it
+  /// into one batch (see StaticBatch) instead of walking it every view
+  void addStatic(std::shared_ptr<Renderable> g) {
+    statics.push_back(g.get());
+    add(std::move(g));
+  }
+
+  /// goes up whenever geometry is added or removed or any of it changes
+  /// (see Renderable::changeSerial): equal serials, same contents
+  unsigned changeSerial() const {
+    unsigned s = edits;
+    for (auto &g : geometry)
+      s += g->changeSerial();
+    return s;
+  }
+  const std::vector<Renderable *> &getStatic() const { return statics; }
+
+  /// drawn behind everything else in every view of this cell (may be null)
+  void setSky(std::shared_ptr<Skybox> s) { sky = std::move(s); }
+  Skybox *getSky() const { return sky.get(); }
 
 private:
   std::vector<std::shared_ptr<Renderable>> geometry;
+  std::vector<Renderable *> statics; // also in geometry
   std::vector<std::shared_ptr<Portal>> portals;
+  std::shared_ptr<Skybox> sky;
+  unsigned edits = 0;
 };
 
 #endif
@@ -5,18 +5,40 @@
 class AdaptiveFramebuffer {
 public:
   AdaptiveFramebuffer() = default;
+  ~AdaptiveFramebuffer();
+
+  AdaptiveFramebuffer(const AdaptiveFramebuffer &) = delete;
+  AdaptiveFramebuffer &operator=(const AdaptiveFramebuffer &) = delete;
+
   void allocate(int w, int h);
   void bind();
   void unbind();
   GLuint colorTex() const { return color; }
+  GLuint depthTex() const { return depth; }
+  GLuint framebuffer() const { return fbo; }
+  int width() const { return w; }
+  int height() const { return h; }
 
-  // choose next size based on screen-coverage fraction (0-1)
+  // full-resolution size the fraction is relative to (the screen)
+  void setBaseSize(int W, int H);
+
+  // choose next size based on screen-coverage fraction (0-1) of the base
+  // pixel count; grows at once, shrinks only after it has been too big for a
+  // few frames so the target isn't reallocated every frame
   void setTargetFraction(float frac);
 
 private:
+  static constexpr float kMinFraction = 1.f / 64.f; // 1/8 per axis
+  static constexpr float kGrowHeadroom = 1.25f;     // per axis
+  static constexpr float kShrinkBelow = 0.5f;       // of current pixels
+  static constexpr int kShrinkDelay = 30;           // frames
+  static constexpr int kAlign = 16;
+
   GLuint fbo{0}, color{0}, depth{0};
   int w{0}, h{0};
+  int baseW{0}, baseH{0};
   float targetFraction{1.f};
+  int shrinkFrames{0};
 };
 
 #endif
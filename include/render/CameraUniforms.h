@@ -0,0 +1,49 @@
+#ifndef CAMERA_UNIFORMS_H
+#define CAMERA_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/// The std140 "Camera" uniform block every shader in src/shader/ reads.
+/// Each view drawn in a frame gets its own slot of one buffer, bound with
+/// glBindBufferRange; returning to a parent view after a nested one is a
+/// rebind, not a re-upload.
+class CameraUniforms {
+public:
+  CameraUniforms() = default;
+  ~CameraUniforms();
+
+  CameraUniforms(const CameraUniforms &) = delete;
+  CameraUniforms &operator=(const CameraUniforms &) = delete;
+
+  void beginFrame(); ///< orphan last frame's slots and start over
+
+  /// store a view's camera in a new slot and bind it; returns the slot
+  int push(const glm::mat4 &V, const glm::mat4 &P, const glm::vec3 &eye,
+           const glm::vec4 &clipPlane = glm::vec4(0.f));
+  /// rebind a slot pushed earlier this frame
+  void bind(int slot);
+  int current() const { return cur; }
+
+private:
+  // mirrors the GLSL block (std140: columns and vec4s are 16-byte aligned)
+  struct Block {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 viewProj;
+    glm::vec4 eye;       // w = 1
+    glm::vec4 clipPlane; // world space, for gl_ClipDistance[0]
+  };
+  static_assert(sizeof(Block) == 224, "Camera block must match std140");
+
+  void reserve(int slots);
+
+  GLuint ubo = 0;
+  GLsizeiptr stride = 0; // Block rounded up to the offset alignment
+  int capacity = 0;      // slots the buffer has room for
+  int cur = -1;
+  std::vector<Block> blocks; // this frame's, to refill a grown buffer
+};
+
+#endif
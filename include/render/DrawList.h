@@ -0,0 +1,73 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "shape/Bounds.h"
+
+class Renderable;
+class Shader;
+
+/// state changes made while submitting a list (program, texture, VAO binds)
+struct DrawListStats {
+  int packets = 0;
+  int naiveChanges = 0; // what drawing each packet on its own would bind
+  int programs = 0;     // ... what the sorted, filtered submit did bind
+  int textures = 0;
+  int vaos = 0;
+  long long triangles = 0; // drawn by packets that report them (models)
+  int multiDraws = 0;      // glMultiDrawElementsIndirect calls (StaticBatch)
+  int batchedDraws = 0;    // ... and the draws they issued
+  int gpuCulled = 0;       // ... of which a compute pass culled first
+  int changes() const { return programs + textures + vaos; }
+};
+
+/// One view's draws as packets with a 64-bit sort key
+///   [63..56] program  [55..40] texture  [39..24] VAO  [23..0] depth
+/// so that state-sharing draws end up adjacent (front to back within a
+/// state). submit() sorts, binds each piece of state only when it differs
+/// from the previous packet's, and lets the object issue the draw itself.
+class DrawList {
+public:
+  struct Packet {
+    std::uint64_t key;
+    const Shader *shader; // nullptr: object binds its own state (render())
+    GLenum textureTarget;
+    GLuint texture; // on unit 0; 0 = none
+    GLuint vao;
+    Renderable *object;
+    int part; // passed back to object->drawPart()
+    int triangles;
+  };
+
+  void begin(const glm::vec3 &eye, float farPlane);
+
+  /// level-of-detail scale for this view: <pixelsPerUnit> is how many pixels
+  /// a unit-sized object covers at distance 1 (0 turns detail selection off)
+  void setDetail(float pixelsPerUnit) { detailScale = pixelsPerUnit; }
+  /// diameter of <b> on screen in pixels (infinite with detail turned off)
+  float screenSize(const Bounds &b) const;
+
+  /// a draw whose state is bound by the list; the object's drawPart(part)
+  /// only sets per-draw uniforms and issues the call
+  void add(const Shader *shader, GLenum textureTarget, GLuint texture,
+           GLuint vao, Renderable *object, int part, const Bounds &bounds,
+           int triangles = 0);
+  /// a draw that binds its own state (falls back to object->render())
+  void addOpaque(Renderable *object, const Bounds &bounds);
+
+  void submit(DrawListStats &stats);
+
+private:
+  std::uint32_t depthBits(const Bounds &b) const;
+
+  std::vector<Packet> packets;
+  glm::vec3 eye{0.f};
+  float farPlane{100.f};
+  float detailScale{0.f};
+};
+
+#endif
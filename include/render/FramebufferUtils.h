@@ -3,15 +3,17 @@
 
 #include <glad/glad.h>
 
+#include "util/GLState.h"
+
 namespace fb {
 
-/* Create an empty RGBA8 2-D texture; returns id */
-inline GLuint makeColorTex(int w, int h) {
+/* Create an empty 2-D colour texture (RGBA8 by default); returns id */
+inline GLuint makeColorTex(int w, int h, GLenum internalFmt = GL_RGBA8) {
   GLuint tex{};
   glGenTextures(1, &tex);
-  glBindTexture(GL_TEXTURE_2D, tex);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-               nullptr);
+  GLState::inst().bindTexture(GL_TEXTURE_2D, tex);
+  glTexImage2D(GL_TEXTURE_2D, 0, internalFmt, w, h, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   return tex;
@@ -21,7 +23,7 @@ inline GLuint makeColorTex(int w, int h) {
 inline GLuint makeDepthTex(int w, int h) {
   GLuint tex{};
   glGenTextures(1, &tex);
-  glBindTexture(GL_TEXTURE_2D, tex);
+  GLState::inst().bindTexture(GL_TEXTURE_2D, tex);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, w, h, 0,
                GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
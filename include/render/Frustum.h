@@ -0,0 +1,47 @@
+#ifndef RENDER_FRUSTUM_H
+#define RENDER_FRUSTUM_H
+
+#include <array>
+#include <glm/glm.hpp>
+
+#include "shape/Bounds.h"
+
+/// The six clip planes of a view-projection, optionally narrowed to an NDC
+/// sub-rectangle (the part of a portal view that can reach the screen).
+/// Planes come straight from the matrix rows, so an oblique projection's
+/// near plane is the portal plane.
+class Frustum {
+public:
+  explicit Frustum(const glm::mat4 &VP, const glm::vec2 &lo = glm::vec2(-1.f),
+                   const glm::vec2 &hi = glm::vec2(1.f)) {
+    glm::vec4 r0 = row(VP, 0), r1 = row(VP, 1), r2 = row(VP, 2),
+              r3 = row(VP, 3);
+    planes = {r0 - lo.x * r3, hi.x * r3 - r0, // left, right
+              r1 - lo.y * r3, hi.y * r3 - r1, // bottom, top
+              r3 + r2,        r3 - r2};       // near, far
+  }
+
+  // conservative: false only if the box lies wholly outside one plane
+  bool intersects(const Bounds &b) const {
+    if (b.empty())
+      return true;
+    glm::vec3 c = b.center(), e = b.extent();
+    for (const glm::vec4 &p : planes) {
+      // signed distance of the centre vs. the box's reach along the normal
+      // (the planes aren't normalised; both sides scale alike)
+      glm::vec3 n(p);
+      if (glm::dot(n, c) + p.w + glm::dot(glm::abs(n), e) < 0.f)
+        return false;
+    }
+    return true;
+  }
+
+private:
+  static glm::vec4 row(const glm::mat4 &M, int i) {
+    return glm::vec4(M[0][i], M[1][i], M[2][i], M[3][i]);
+  }
+
+  std::array<glm::vec4, 6> planes;
+};
+
+#endif
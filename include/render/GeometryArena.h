@@ -0,0 +1,134 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <cstddef>
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+/// vertex layouts the arena keeps apart; each one has its own buffers and
+/// VAO (attribute locations as the shaders declare them)
+enum class VertexFormat {
+  P3,     // 0: vec3 position                  (portal quads, sky)
+  P3T2,   // 0: position, 1: vec2 uv           (textured quads)
+  P3N3T2, // 0: position, 1: normal, 2: uv     (Vertex, models)
+  Count
+};
+
+/// what the arena holds right now (see GeometryArena::stats)
+struct GeometryArenaStats {
+  int pages = 0;
+  int blocks = 0;
+  std::size_t bytes = 0;    // in live blocks, vertices + indices
+  std::size_t capacity = 0; // of every page's buffers
+  // share of the free space that is not part of its page's largest free
+  // range: 0 while every page's free space is in one piece
+  float fragmentation = 0.f;
+};
+
+/// First-fit free list over [0, capacity) elements. Freed ranges merge with
+/// their free neighbours, so the list only ever holds the actual holes.
+class RangeAllocator {
+public:
+  static constexpr std::size_t kNone = ~std::size_t(0);
+
+  explicit RangeAllocator(std::size_t capacity);
+
+  /// offset of <n> free elements, or kNone if no range is big enough
+  std::size_t allocate(std::size_t n);
+  void release(std::size_t offset, std::size_t n);
+
+  std::size_t capacity() const { return cap; }
+  std::size_t used() const { return inUse; }
+  std::size_t largestFree() const;
+
+private:
+  std::map<std::size_t, std::size_t> holes; // offset → size
+  std::size_t cap, inUse = 0;
+};
+
+class GeometryBlock;
+
+/// Static geometry of every shape in a few large buffers. Each vertex format
+/// gets pages - one VAO over one vertex and one index buffer - and a shape's
+/// vertices and indices are sub-allocated from a page's free lists. Draws
+/// of the same format share the page's VAO, so the draw list binds it once
+/// instead of once per shape; the block's offsets go to the draw call
+/// (glDrawElementsBaseVertex).
+///
+/// A request bigger than a whole page gets a page of its own. Pages live as
+/// long as a block refers to them, so shapes may outlive the arena.
+class GeometryArena {
+public:
+  /// per-instance uint attribute of every page's VAO: 0, 1, 2, ... so an
+  /// instanced draw's baseInstance arrives in the vertex shader (the draw's
+  /// index in a StaticBatch). gl_InstanceID leaves baseInstance out.
+  static constexpr GLuint kDrawIndexAttrib = 7;
+  static constexpr GLuint kMaxDrawIndex = 1u << 16;
+
+  static GeometryArena &inst() {
+    static GeometryArena a;
+    return a;
+  }
+
+  GeometryArena(const GeometryArena &) = delete;
+  GeometryArena &operator=(const GeometryArena &) = delete;
+
+  /// copies the vertices (of <format>'s layout) and indices - relative to
+  /// the first vertex - into a page and returns their place in it
+  GeometryBlock allocate(VertexFormat format, const void *vertices,
+                         std::size_t vertexCount, const unsigned *indices,
+                         std::size_t indexCount);
+
+  GeometryArenaStats stats() const;
+
+  static std::size_t stride(VertexFormat format);
+
+private:
+  friend class GeometryBlock;
+  struct Page;
+
+  GeometryArena() = default;
+  ~GeometryArena();
+
+  std::shared_ptr<Page> newPage(VertexFormat format, std::size_t vertices,
+                                std::size_t indices);
+
+  std::vector<std::shared_ptr<Page>> pages;
+  GLuint drawIndices = 0; // 0 .. kMaxDrawIndex-1, shared by every page
+};
+
+/// A shape's share of the arena: released when the handle goes away.
+class GeometryBlock {
+public:
+  GeometryBlock() = default;
+  GeometryBlock(GeometryBlock &&) noexcept = default;
+  GeometryBlock &operator=(GeometryBlock &&rhs) noexcept;
+  ~GeometryBlock();
+
+  explicit operator bool() const { return page != nullptr; }
+
+  GLuint vertexArray() const;
+  VertexFormat format() const { return fmt; }
+  GLint baseVertex() const { return GLint(vertexOffset); }
+  GLuint firstIndex() const { return GLuint(indexOffset); }
+  GLsizei vertexCount() const { return GLsizei(vertices); }
+  GLsizei indexCount() const { return GLsizei(indices); }
+
+  // just the draw call: program and vertexArray() already bound. <first>
+  // and <count> pick a range of the block's own indices.
+  void draw() const { draw(indexCount(), 0); }
+  void draw(GLsizei count, GLsizei first) const;
+
+private:
+  friend class GeometryArena;
+  void release();
+
+  std::shared_ptr<GeometryArena::Page> page;
+  VertexFormat fmt = VertexFormat::P3;
+  std::size_t vertexOffset = 0, vertices = 0;
+  std::size_t indexOffset = 0, indices = 0;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include <array>
+#include <glad/glad.h>
+#include <map>
+#include <utility>
+
+class Portal;
+
+/// Per-portal "any samples passed" queries, keyed by (portal, recursion
+/// level). Every key owns a small ring of query objects; results are only
+/// read once the driver reports them available, so the CPU never waits on
+/// the GPU. Decisions use the newest result that has come back (normally the
+/// previous frame's).
+class OcclusionQueries {
+public:
+  using Key = std::pair<const Portal *, int>;
+
+  OcclusionQueries() = default;
+  ~OcclusionQueries();
+
+  OcclusionQueries(const OcclusionQueries &) = delete;
+  OcclusionQueries &operator=(const OcclusionQueries &) = delete;
+
+  void beginFrame(int frameNo); ///< collect finished results, evict stale
+  void clear();
+
+  /// true only if the latest result for <k> says no sample passed
+  bool occluded(const Key &k) const;
+
+  /// wrap a draw; begin() returns false (and nothing must be ended) when
+  /// every query of the ring is still in flight
+  bool begin(const Key &k);
+  void end();
+
+private:
+  static constexpr int kRing = 3;
+  static constexpr int kEvictFrames = 120;
+
+  struct Slot {
+    GLuint id = 0;
+    int frame = -1;
+    bool pending = false;
+  };
+  struct Node {
+    std::array<Slot, kRing> ring;
+    int head = 0;
+    int resultFrame = -1;
+    bool visible = true;
+    int lastIssued = 0;
+  };
+
+  GLenum target() const;
+
+  std::map<Key, Node> nodes;
+  int frame{0};
+};
+
+#endif
@@ -5,17 +5,102 @@
 #include "app/Camera.h"
 #include "portal/Portal.h"
 #include "portal/Scene.h"
+#include "render/AdaptiveFramebuffer.h"
+#include "render/CameraUniforms.h"
+#include "render/DrawList.h"
+#include "render/OcclusionQueries.h"
+#include "render/PortalScheduler.h"
+#include "render/RenderTargetPool.h"
+#include "render/StaticBatch.h"
 #include <GL/gl.h>
 #include <glm/ext/vector_float4.hpp>
 #include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 
-struct PortalPass {
-  GLuint fbo = 0;
-  GLuint colorTex = 0;
-  GLuint depthRb = 0;
-  int width = 512; // render‐to‐tex resolution
-  int height = 512;
+// Axis-aligned screen region in NDC; a portal view only ever needs the pixels
+// inside the rect its opening covers on the parent target.
+struct PortalRect {
+  glm::vec2 lo{-1.f}, hi{1.f};
+
+  bool empty() const { return lo.x >= hi.x || lo.y >= hi.y; }
+  PortalRect intersect(const PortalRect &o) const {
+    return {glm::max(lo, o.lo), glm::min(hi, o.hi)};
+  }
+  // fraction of the target covered (0-1)
+  float coverage() const {
+    return empty() ? 0.f : (hi.x - lo.x) * (hi.y - lo.y) * 0.25f;
+  }
+};
+
+// how portal views reach the screen
+enum class PortalMode {
+  Texture, // render each view into an FBO, then texture the portal quad
+  Stencil, // mark openings in the stencil buffer, draw views in place
+};
+
+// per-frame knobs for the portal traversal (edited from ImGui)
+struct PortalOptions {
+  // FBO path: size each view's target by how many of its pixels reach the
+  // screen, scaled down further with recursion depth
+  bool adaptiveResolution = true;
+  // skip a view whose opening had no visible samples last frame
+  bool occlusionQueries = true;
+  // re-use (and depth-reproject) a view's previous texture while its camera
+  // stays within these limits and nothing the view shows has changed (see
+  // Cell::changeSerial); needs adaptiveResolution's persistent targets
+  bool temporalReuse = false;
+  int maxStaleFrames = 4;
+  float reuseMaxMove = 0.02f; // world units
+  float reuseMaxAngle = 0.5f; // degrees
+  // spend at most frameBudgetMs of (measured) GPU time on portal views,
+  // biggest/shallowest first; the rest show their last texture or a fill
+  bool frameBudget = false;
+  float frameBudgetMs = 8.f;
+  // render each distinct view once per frame: a node whose camera and cell
+  // match an already rendered one composites that texture (needs
+  // adaptiveResolution, pool targets are released right after compositing)
+  bool memoizeViews = true;
+  // skip geometry whose bounds miss the part of the view that's on screen
+  bool frustumCulling = true;
+  // draw models at a level of detail that fits their size on screen (and
+  // coarser still the deeper the view is nested)
+  bool meshLod = true;
+  // submit each cell's static geometry as one compiled multi-draw-indirect
+  // batch (GL 4.3; the batched models always draw at full detail)
+  bool indirectDraw = true;
+  // ... and cull that batch per view in a compute pass (with frustumCulling)
+  // instead of drawing all of it
+  bool gpuCulling = true;
+};
+
+// geometry submitted vs. culled by one view (level 0 = the main camera)
+struct PortalViewStats {
+  int level = 0;
+  int drawn = 0;
+  int culled = 0;
+  long long triangles = 0; // of the models drawn
+};
+
+struct PortalStats {
+  int viewNodes = 0; // portal-graph nodes visited (before any culling)
+  int viewsShared = 0; // composited from an equivalent view's texture
+  int portalsDrawn = 0;
+  int portalsCulled = 0; // back-facing, off-screen or outside parent region
+  int portalsOccluded = 0; // skipped on a previous-frame occlusion query
+  int portalsReused = 0;   // drawn from an earlier frame's texture
+  int portalsDeferred = 0; // didn't fit the frame budget
+  float portalPlannedMs = 0.f; // estimated GPU cost of the views admitted
+  int targetsPeak = 0;   // most offscreen targets live at once
+  int targetsAllocated = 0;
+  double portalTexels = 0;     // pixels rendered into portal targets
+  double portalTexelsFull = 0; // ... had every target been full-res
+  int objectsDrawn = 0;
+  int objectsCulled = 0; // outside the view frustum
+  std::vector<PortalViewStats> perView; // in the order views were drawn
+  DrawListStats draws; // state changes, summed over all views
 };
 
 namespace PortalUtils {
@@ -25,7 +110,10 @@ void checkPortalTeleport(Scene &scene, Camera &cam);
 class PortalRenderer {
 public:
   void init(int screenW, int screenH);
-  void renderScene(const Scene &scene, const Camera &cam, int maxDepth);
+  void renderScene(const Scene &scene, const Camera &cam, int maxDepth,
+                   PortalMode mode = PortalMode::Texture,
+                   const PortalOptions &opts = {});
+  const PortalStats &stats() const { return frameStats; }
 
   static Camera throughPortal(const Camera &camSrc, const glm::mat4 &srcToDst) {
     // Copy the source camera to keep projection settings
@@ -84,13 +172,98 @@ public:
 
 private:
   void renderCell(const class Cell &, const Camera &, int depth,
-                  const class Portal *entryPortal);
-  void renderPortal(class Portal &, const Camera &, int depth);
-  // stencil depth tracking
+                  const class Portal *entryPortal, const PortalRect &region);
+  bool renderPortal(class Portal &, const Camera &, int depth,
+                    const PortalRect &parentRegion);
+  void queryOpenings(const std::vector<class Portal *> &);
+  void bindTarget(GLuint fbo, int w, int h, const PortalRect &region);
+  void drawGeometry(const class Cell &, const glm::mat4 &V, const glm::mat4 &P,
+                    const PortalRect &region);
+
+  // stencil path: views are drawn straight into the default framebuffer
+  void renderCellStencil(const class Cell &, const glm::mat4 &V,
+                         const glm::mat4 &P, const glm::vec3 &eye,
+                         int maxDepth, const class Portal *entryPortal,
+                         const PortalRect &region);
+
+  // stencil depth tracking (= recursion level of the view being drawn; the
+  // FBO path keeps it up to date too)
   int stencilDepth{0};
+  glm::mat4 baseProj{1.f}; // un-skewed projection for oblique clipping
+  // world plane of the portal the current FBO view looks out of (positive
+  // along the view direction), for the Camera block; zero at the root
   glm::vec4 clipEq{0, 0, 0, 0};
-  std::vector<PortalPass> portalPasses;
+  CameraUniforms cameras; // one slot per view drawn this frame
+  DrawList drawList;      // reused by every view
+  RenderTargetPool targets;
+  // per cell, compiled the first time it is drawn with indirectDraw on
+  std::map<const class Cell *, std::unique_ptr<StaticBatch>> batches;
+  StaticBatch *batchFor(const class Cell &);
+
+  // coverage-sized targets, one per (portal, recursion level): a node never
+  // shares its target with an ancestor, and same-key siblings run one after
+  // the other, each compositing before the next renders
+  struct AdaptiveTarget {
+    AdaptiveFramebuffer fb;
+    int lastFrame = 0;
+    unsigned renderSerial = 0; // bumped whenever the texture is redrawn
+
+    // what the texture currently holds (temporal reuse)
+    bool historyValid = false;
+    // key visited more than once this frame or the last one it was seen
+    // in: the texture may hold a sibling's view, so it isn't reused
+    int visits = 0, lastVisits = 0;
+    bool shared = false;
+    int historyFrame = 0;
+    unsigned historyContent = 0; // contentSerial() of what it shows
+    int historyW = 0, historyH = 0;
+    glm::mat4 historyVP{1.f};
+    glm::vec3 historyPos{0.f}, historyFront{0.f};
+  };
+  std::map<std::pair<const class Portal *, int>, AdaptiveTarget> adaptive;
+  static constexpr int kAdaptiveIdleFrames = 8;
+  static constexpr float kDepthScale = 0.75f; // per-axis, per recursion level
+  bool canReuse(const AdaptiveTarget &, const Camera &camDst,
+                unsigned content) const;
+  // change serial of everything a view of <cell> with <depth> levels left
+  // can show: the cell, the openings out of it and the cells behind them
+  static unsigned contentSerial(const class Cell &, int depth);
+
+  // views rendered this frame, keyed by everything that decides their
+  // content: the entry portal (and so the cell), the depth left and the
+  // camera. Different portal chains often end in the same view, which is
+  // then drawn once instead of once per chain.
+  struct ViewMemo {
+    const class Portal *entry;
+    int depth;
+    glm::mat4 view;
+    float zoom;
+    PortalRect rect; // part of the texture that was rendered
+    AdaptiveTarget *target;
+    unsigned serial; // target->renderSerial when it held this view
+  };
+  std::vector<ViewMemo> views;
+  const ViewMemo *findView(const class Portal *entry, int depth,
+                           const glm::mat4 &V, float zoom,
+                           const PortalRect &rect) const;
+
+  OcclusionQueries occlusion;
+
+  PortalScheduler scheduler;
+  PortalScheduler::Key curKey{PortalScheduler::kRoot}; // view being drawn
+  float curPriority{1.f};
+  static constexpr float kDepthPriority = 0.5f; // per recursion level
+  static constexpr float kDepthDetail = 0.5f;   // LOD size, per level
+
+  PortalOptions options;
+  int frameNo{0};
   int screenW, screenH;
+
+  // target currently being drawn into (restored after each nested pass)
+  GLuint curFbo{0};
+  int curW{0}, curH{0};
+
+  PortalStats frameStats;
 };
 
 #endif
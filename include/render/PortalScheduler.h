@@ -0,0 +1,71 @@
+#ifndef PORTAL_SCHEDULER_H
+#define PORTAL_SCHEDULER_H
+
+#include <array>
+#include <glad/glad.h>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+class Portal;
+
+/// Frame-time budget for portal views. Every view the traversal reaches is
+/// recorded as a candidate with a priority (projected area, decayed by
+/// recursion depth) and its parent view. Each view's pass is bracketed by
+/// GL_TIMESTAMP queries that are read back without stalling. At the start of
+/// a frame the previous frame's candidates are sorted by priority and
+/// admitted until their measured GPU cost would exceed the budget; a child
+/// is only admitted if its parent is. Views never measured are admitted.
+class PortalScheduler {
+public:
+  using Key = std::pair<const Portal *, int>; // (portal, recursion level)
+  static constexpr Key kRoot{nullptr, -1};
+
+  PortalScheduler() = default;
+  ~PortalScheduler();
+
+  PortalScheduler(const PortalScheduler &) = delete;
+  PortalScheduler &operator=(const PortalScheduler &) = delete;
+
+  void beginFrame(float budgetMs);
+  void record(const Key &k, const Key &parent, float priority);
+  bool admitted(const Key &k) const;
+
+  /// bracket a view's pass; returns a handle for endTiming (-1 = not timed,
+  /// every query of the key's ring still in flight)
+  int beginTiming(const Key &k);
+  void endTiming(const Key &k, int handle);
+
+  /// what this frame's admitted views are expected to cost: their latest
+  /// measured exclusive times, from earlier frames' queries
+  float plannedMs() const { return lastSpentMs; }
+
+private:
+  static constexpr int kRing = 3;
+  static constexpr int kEvictFrames = 120;
+
+  struct Slot {
+    GLuint q[2] = {0, 0};
+    bool pending = false;
+  };
+  struct Timing {
+    std::array<Slot, kRing> ring;
+    int head = 0;
+    float ms = -1.f; // latest inclusive duration, < 0 = never measured
+    int lastUsed = 0;
+  };
+  struct Candidate {
+    Key key, parent;
+    float priority;
+  };
+
+  std::map<Key, Timing> timings;
+  std::vector<Candidate> candidates; // this frame, in traversal order
+  std::set<Key> known;               // keys scheduled this frame
+  std::set<Key> admit;
+  float lastSpentMs{0.f};
+  int frame{0};
+};
+
+#endif
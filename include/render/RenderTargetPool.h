@@ -0,0 +1,54 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+
+struct PortalPass {
+  GLuint fbo = 0;
+  GLuint colorTex = 0;
+  GLuint depthRb = 0;
+  int width = 512; // render‐to‐tex resolution
+  int height = 512;
+  GLenum format = GL_RGBA8;
+
+  bool inUse = false;
+  int idleFrames = 0;
+};
+
+/// Hands out offscreen targets per portal traversal node. A target stays
+/// reserved from acquire() until the parent has composited it (release()),
+/// so nested passes can never overwrite a texture that is still going to be
+/// sampled. Targets are keyed by size + colour format and recycled; targets
+/// that go unused for a few frames (e.g. after a resize) are destroyed.
+class RenderTargetPool {
+public:
+  RenderTargetPool() = default;
+  ~RenderTargetPool();
+
+  RenderTargetPool(const RenderTargetPool &) = delete;
+  RenderTargetPool &operator=(const RenderTargetPool &) = delete;
+
+  PortalPass *acquire(int w, int h, GLenum colorFormat = GL_RGBA8);
+  void release(PortalPass *pass);
+
+  void beginFrame(); ///< resets the peak counter, evicts idle targets
+  void trim();       ///< destroy every target that is not in use right now
+
+  int allocated() const { return int(passes.size()); }
+  int inUse() const { return used; }
+  int peakInUse() const { return peak; }
+
+private:
+  static constexpr int kMaxIdleFrames = 4;
+
+  static void create(PortalPass &pp);
+  static void destroy(PortalPass &pp);
+
+  std::vector<std::unique_ptr<PortalPass>> passes;
+  int used{0};
+  int peak{0};
+};
+
+#endif
@@ -16,7 +16,11 @@ public:
   void draw(const Scene &scene, const Camera &cam);
   void resize(int w, int h);
 
+  const PortalRenderer &portals() const { return *portalRenderer; }
+
   int recursionDepth{3}; // editable from ImGui
+  PortalMode portalMode{PortalMode::Texture}; // editable from ImGui
+  PortalOptions portalOptions;                // editable from ImGui
 
 private:
   int w, h;
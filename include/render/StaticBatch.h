@@ -0,0 +1,124 @@
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "shape/Bounds.h"
+
+class Renderable;
+class Shader;
+class Texture2D;
+struct DrawListStats;
+
+/// one indexed draw of a static shape, as it goes into a StaticBatch
+struct StaticDraw {
+  const Shader *shader; // the shape's own program (see ShaderStore::indirect)
+  std::shared_ptr<Texture2D> texture; // on unit 0; may be null
+  GLuint vao;                         // a GeometryArena page's
+  GLsizei count;                      // indices
+  GLuint firstIndex;                  // in the page's index buffer
+  GLint baseVertex;
+  glm::mat4 model;
+  Bounds bounds; // world space; empty: never culled
+};
+
+/// Shapes that can hand their draws over to a StaticBatch. They must not
+/// change (transform, texture, geometry) once their cell is compiled.
+class StaticShape {
+public:
+  virtual ~StaticShape() = default;
+  /// appends this shape's draws; false if any of them can't be batched
+  virtual bool collect(std::vector<StaticDraw> &out) const = 0;
+};
+
+/// A cell's static geometry compiled once into a GL 4.3 multi-draw-indirect
+/// command buffer, with every draw's model matrix in a shader storage
+/// buffer. A view then submits the whole set in one glMultiDrawElementsIndirect
+/// per run of draws sharing program, arena page and texture, instead of
+/// walking the shapes.
+///
+/// A command's baseInstance is its draw's index. It reaches the vertex
+/// shader through the arena's per-instance draw-index attribute (see
+/// GeometryArena::kDrawIndexAttrib), which picks the matrix.
+///
+/// submitCulled() leaves visibility to the GPU: a compute pass tests every
+/// draw's bounds against the view and appends the ones that pass to that
+/// view's own command list, one range per run. The draw then reads the
+/// number of commands from the GPU too (ARB_indirect_parameters), or walks
+/// the whole range, where unfilled commands draw nothing.
+class StaticBatch {
+public:
+  // binding point of the "Draws" storage block in the *_indirect shaders
+  static constexpr GLuint kDrawsBinding = 0;
+
+  StaticBatch() = default;
+  StaticBatch(const StaticBatch &) = delete;
+  StaticBatch &operator=(const StaticBatch &) = delete;
+  ~StaticBatch();
+
+  /// GL 4.3 with ARB_multi_draw_indirect and
+  /// ARB_shader_storage_buffer_object loaded
+  static bool supported();
+  /// ... and the compute, buffer-clear and barrier entry points that
+  /// submitCulled() needs
+  static bool cullingSupported();
+
+  /// compiles <shapes>: each one whose draws can all be batched is taken,
+  /// the rest are left to the regular path (see covers)
+  void build(const std::vector<Renderable *> &shapes);
+
+  bool covers(const Renderable *shape) const;
+  int shapes() const { return int(taken.size()); }
+  std::size_t builtFrom() const { return sourceCount; }
+
+  /// draws everything; the camera comes from the bound Camera block
+  void submit(DrawListStats &stats) const;
+  /// draws what the bound camera sees within the NDC rectangle lo..hi
+  /// (and in front of its clip plane); each call takes a new slot of this
+  /// frame's culled command lists
+  void submitCulled(DrawListStats &stats, const glm::vec2 &lo,
+                    const glm::vec2 &hi);
+  void beginFrame(); ///< orphan last frame's culled lists and start over
+
+private:
+  struct Command { // DrawElementsIndirectCommand
+    GLuint count, instanceCount, firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+  struct DrawBounds { // mirrors cull.comp.glsl (std430)
+    glm::vec4 lo, hi;
+    GLuint run, runFirst, pad[2];
+  };
+  static_assert(sizeof(DrawBounds) == 48, "DrawBounds must match std430");
+  struct Run {
+    const Shader *program; // the indirect variant
+    GLuint vao;
+    std::shared_ptr<Texture2D> texture;
+    GLsizei first, count; // commands
+  };
+
+  // <commands>: the buffer bound to GL_DRAW_INDIRECT_BUFFER; with <counts>,
+  // each run draws as many as the parameter buffer holds at <counts>
+  void drawRuns(DrawListStats &stats, GLintptr commands,
+                const GLintptr *counts) const;
+  void reserveSlots(int n);
+
+  std::vector<const Renderable *> taken; // sorted
+  std::vector<Run> runs;
+  long long triangleCount = 0;
+  std::size_t sourceCount = 0;
+  GLsizei commandCount = 0;
+  GLuint commandBuffer = 0, drawBuffer = 0, boundsBuffer = 0;
+
+  // culled lists: per slot (one per culled view this frame) a copy of the
+  // command layout and a counter per run
+  GLuint visibleBuffer = 0, countBuffer = 0;
+  int slots = 0, slotCapacity = 0;
+};
+
+#endif
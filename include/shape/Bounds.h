@@ -0,0 +1,49 @@
+#ifndef SHAPE_BOUNDS_H
+#define SHAPE_BOUNDS_H
+
+#include <cfloat>
+#include <cmath>
+#include <glm/glm.hpp>
+
+/// Axis-aligned box (and the sphere around it). A default-constructed Bounds
+/// is empty: shapes that can't tell where they are report that and are never
+/// culled.
+struct Bounds {
+  glm::vec3 min{FLT_MAX};
+  glm::vec3 max{-FLT_MAX};
+
+  bool empty() const { return min.x > max.x; }
+
+  void expand(const glm::vec3 &p) {
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+  }
+  void expand(const Bounds &b) {
+    if (!b.empty()) {
+      expand(b.min);
+      expand(b.max);
+    }
+  }
+
+  glm::vec3 center() const { return (min + max) * 0.5f; }
+  glm::vec3 extent() const { return (max - min) * 0.5f; } // half-size
+  float radius() const { return glm::length(extent()); }
+
+  // box around this one after an affine transform (Arvo's method: the new
+  // half-size is |M| applied to the old one)
+  Bounds transformed(const glm::mat4 &M) const {
+    if (empty())
+      return {};
+    glm::vec3 c = glm::vec3(M * glm::vec4(center(), 1.f));
+    glm::vec3 e = extent(), r(0.f);
+    for (int col = 0; col < 3; ++col)
+      for (int row = 0; row < 3; ++row)
+        r[row] += std::abs(M[col][row]) * e[col];
+    Bounds b;
+    b.min = c - r;
+    b.max = c + r;
+    return b;
+  }
+};
+
+#endif
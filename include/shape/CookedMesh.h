@@ -0,0 +1,60 @@
+#ifndef SHAPE_COOKED_MESH_H
+#define SHAPE_COOKED_MESH_H
+
+#include "shape/MeshData.h"
+#include "util/MappedFile.h"
+#include <cstdint>
+#include <string>
+
+/// A MeshData saved by the meshcook tool next to its source
+/// ("<model>.cmesh"): header, submesh table, vertices, indices (every level
+/// of detail, see MeshData). Every section is 4-byte aligned and in the
+/// in-memory layout, so a mapped file is uploaded to GL as is. The header
+/// records the format version, the import flags, sizeof(Vertex) and the
+/// source file's size and mtime; if any of them no longer match, the file
+/// is stale and ignored.
+class CookedMesh {
+public:
+  static constexpr std::uint32_t kMagic = 0x48534d43; // "CMSH"
+  static constexpr std::uint32_t kVersion = 2;
+
+  static std::string pathFor(const std::string &source) {
+    return source + ".cmesh";
+  }
+
+  /// cook <data>, imported from <source> with <importFlags>
+  static bool write(const std::string &source, const MeshData &data,
+                    unsigned importFlags);
+
+  /// maps pathFor(source); false if it is missing, stale or truncated
+  CookedMesh(const std::string &source, unsigned importFlags);
+  explicit operator bool() const { return hdr != nullptr; }
+
+  std::uint32_t submeshCount() const { return hdr->submeshCount; }
+  MeshData::Submesh submesh(std::uint32_t i) const;
+  Bounds bounds() const;
+  const Vertex *vertices() const { return verts; }
+  const unsigned *indices() const { return idx; }
+
+private:
+  struct Header {
+    std::uint32_t magic, version, importFlags, vertexSize;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    std::uint32_t submeshCount, vertexCount, indexCount, reserved;
+    float min[3], max[3];
+  };
+  struct SubmeshRecord {
+    std::uint32_t firstVertex, vertexCount, firstIndex, indexCount;
+    std::uint32_t lodIndexCount[MeshData::kMaxLods];
+    float min[3], max[3];
+  };
+
+  MappedFile file;
+  const Header *hdr = nullptr;
+  const SubmeshRecord *subs = nullptr;
+  const Vertex *verts = nullptr;
+  const unsigned *idx = nullptr;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SHAPE_DDS_IMAGE_H
+#define SHAPE_DDS_IMAGE_H
+
+#include "util/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// A block-compressed 2D texture with its mip chain in a DDS file, as written
+/// by the texcompress tool next to its source ("<image>.dds"). Reads BC1 and
+/// BC3 (legacy DXT1/DXT5 headers) and BC7 (DX10 header), so files from other
+/// DDS tools load too. The levels point straight into the mapped file and go
+/// to glCompressedTexImage2D as they are. No GL involved.
+class DdsImage {
+public:
+  enum class Format { BC1, BC3, BC7 };
+
+  struct Level {
+    int width, height;
+    const unsigned char *data;
+    std::size_t size;
+  };
+
+  static std::string pathFor(const std::string &source) {
+    return source + ".dds";
+  }
+
+  /// true if pathFor(source) exists and is not older than <source>
+  static bool isFresh(const std::string &source);
+
+  static std::size_t blockBytes(Format f) { return f == Format::BC1 ? 8 : 16; }
+  static std::size_t levelBytes(Format f, int w, int h) {
+    return std::size_t((w + 3) / 4) * std::size_t((h + 3) / 4) * blockBytes(f);
+  }
+
+  /// writes <levels> (level 0 first, each levelBytes() long) to <path>
+  static bool write(const std::string &path, Format f, int width, int height,
+                    const std::vector<std::vector<unsigned char>> &levels);
+
+  /// maps <path>; false if it is missing, truncated or not BC1/BC3/BC7
+  explicit DdsImage(const std::string &path);
+  explicit operator bool() const { return !levels.empty(); }
+
+  Format format() const { return fmt; }
+  int width() const { return levels[0].width; }
+  int height() const { return levels[0].height; }
+  int levelCount() const { return int(levels.size()); }
+  const Level &level(int i) const { return levels[i]; }
+
+private:
+  MappedFile file;
+  Format fmt = Format::BC1;
+  std::vector<Level> levels;
+};
+
+#endif
@@ -25,6 +25,9 @@ public:
 
 protected:
   explicit GLShape(Shader *shader);
+  /// <ownBuffers> false: no VAO / VBO of its own (vertices in the
+  /// GeometryArena); vao stays 0 unless the shape sets one
+  GLShape(Shader *shader, bool ownBuffers);
 
   GLShape(GLShape &&) noexcept;
   GLShape &operator=(GLShape &&) noexcept;
@@ -0,0 +1,58 @@
+#ifndef SHAPE_INSTANCED_BOXES_H
+#define SHAPE_INSTANCED_BOXES_H
+
+#include "shape/GLShape.h"
+#include "shape/Renderable.h"
+#include "shape/Texture.h"
+#include "util/Shader.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+/// Many textured boxes of one size, drawn with a single instanced call.
+/// Each instance has its own model matrix and a layer of a shared texture
+/// array. Transforms are staged on the CPU and re-uploaded (orphaning the
+/// buffer) the first time the field is drawn after any of them changed.
+class InstancedBoxes : public GLShape, public Renderable {
+public:
+  /// size = full box extent in local space
+  InstancedBoxes(Shader *sh, const glm::vec3 &size,
+                 std::shared_ptr<Texture2DArray> textures);
+  ~InstancedBoxes() noexcept override;
+
+  /// returns the new instance's index
+  int add(const glm::mat4 &model, int layer);
+  void setModel(int i, const glm::mat4 &m) {
+    instances[i].model = m;
+    dirty = boundsDirty = true;
+    touch();
+  }
+  int count() const { return int(instances.size()); }
+
+  void render() override;
+  void emit(DrawList &list) override;
+  void drawPart(int) override;
+  Bounds bounds() const override; // union of all instances
+
+private:
+  struct Instance {
+    glm::mat4 model;
+    float layer;
+  };
+
+  void upload();
+
+  std::vector<Instance> instances;
+  GLuint instanceVbo{0};
+  std::size_t capacity{0}; // instances the GPU buffer has room for
+  bool dirty{true};
+
+  Bounds boxBounds; // one box, local space
+  mutable Bounds cachedBounds;
+  mutable bool boundsDirty{true};
+
+  std::shared_ptr<Texture2DArray> textures;
+  Shader::Uniform<GLint> uTex0;
+};
+
+#endif
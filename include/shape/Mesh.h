@@ -1,26 +1,81 @@
 #ifndef SHAPE_MESH_H
 #define SHAPE_MESH_H
 
+#include "render/GeometryArena.h"
 #include "shape/GLShape.h"
+#include "shape/MeshData.h"
+#include <algorithm>
+#include <cstddef>
 #include <glm/glm.hpp>
 #include <vector>
 
-struct Vertex {
-  glm::vec3 pos;
-  glm::vec3 normal;
-  glm::vec2 tex;
-};
-
-/// A single draw‑call chunk.  Manages its own VAO/VBO via GLShape.
+/// A single draw‑call chunk. Its vertices and indices live in a block of the
+/// GeometryArena, drawn through the arena page's shared VAO.
+///
+/// Drawing needs nothing but the block, so by default a Mesh keeps no CPU
+/// copy of its data once it is uploaded. Code that reads the triangles back
+/// (picking, collision) asks for Residency::CpuCopy.
 class Mesh : public GLShape, public Renderable {
 public:
+  enum class Residency {
+    GpuOnly, // dropped after the upload
+    CpuCopy, // kept: cpuVertices() / cpuIndices()
+  };
+
+  /// one level of detail: a range of the index buffer
+  struct Lod {
+    GLsizei first = 0, count = 0;
+  };
+
   Mesh(Shader *shader, std::vector<Vertex> vertices,
-       std::vector<unsigned> indices);
+       std::vector<unsigned> indices,
+       Residency residency = Residency::GpuOnly);
+  /// uploads straight from the caller's memory (e.g. a mapped cooked file),
+  /// copying it only for Residency::CpuCopy. <lods> split the indices into
+  /// levels of detail; none means a single level with all of them.
+  Mesh(Shader *shader, const Vertex *vertices, std::size_t vertexCount,
+       const unsigned *indices, std::size_t indexCount, const Bounds &bounds,
+       std::vector<Lod> lods = {}, Residency residency = Residency::GpuOnly);
 
   void render() override;
+  // just the draw call: program and VAO already bound. Levels past the last
+  // one draw the last.
+  void draw(int lod = 0) const;
+  GLuint vertexArray() const { return geometry.vertexArray(); }
+
+  int lodCount() const { return int(lods.size()); }
+  GLsizei triangles(int lod = 0) const { return level(lod).count / 3; }
+  // the index range draw(lod) draws, relative to block()
+  const Lod &level(int lod) const {
+    return lods[std::size_t(std::min(lod, lodCount() - 1))];
+  }
+  const GeometryBlock &block() const { return geometry; }
+
+  // in model space: a Mesh is drawn with its owner's model matrix
+  Bounds bounds() const override { return localBounds; }
+
+  /// empty unless the mesh was made with Residency::CpuCopy; the indices
+  /// hold every level of detail back to back (level 0 first)
+  const std::vector<Vertex> &cpuVertices() const { return verts; }
+  const std::vector<unsigned> &cpuIndices() const { return idx; }
+
+  std::size_t cpuBytes() const {
+    return verts.capacity() * sizeof(Vertex) +
+           idx.capacity() * sizeof(unsigned);
+  }
+  std::size_t gpuBytes() const {
+    return std::size_t(geometry.vertexCount()) * sizeof(Vertex) +
+           std::size_t(geometry.indexCount()) * sizeof(unsigned);
+  }
 
 private:
-  std::vector<Vertex> verts;
+  void upload(const Vertex *v, std::size_t nv, const unsigned *i,
+              std::size_t ni);
+
+  std::vector<Vertex> verts; // CPU copies (Residency::CpuCopy only)
   std::vector<unsigned> idx;
+  GeometryBlock geometry;
+  Bounds localBounds;
+  std::vector<Lod> lods;
 };
 #endif
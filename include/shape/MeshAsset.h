@@ -0,0 +1,49 @@
+#ifndef SHAPE_MESH_ASSET_H
+#define SHAPE_MESH_ASSET_H
+
+#include "shape/Mesh.h"
+#include "shape/MeshData.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/// The GPU side of one model file: a Mesh (arena block) per submesh and
+/// their union bounds in model space. Immutable once loaded, so one asset is
+/// shared by every ModelShape that shows the file (see ResourceCache::mesh);
+/// the meshes have no program of their own and are drawn with the owner's.
+///
+/// Loaded from the cooked file (CookedMesh) when there is an up-to-date one,
+/// uploading straight from the mapping; otherwise imported
+/// (MeshData::import). Either way the file's data is gone once it is on the
+/// GPU, unless the meshes are asked to keep a copy (Mesh::Residency).
+class MeshAsset {
+public:
+  explicit MeshAsset(const std::string &path,
+                     unsigned importFlags = MeshData::kDefaultImport,
+                     Mesh::Residency residency = Mesh::Residency::GpuOnly);
+
+  MeshAsset(const MeshAsset &) = delete;
+  MeshAsset &operator=(const MeshAsset &) = delete;
+
+  const std::vector<std::unique_ptr<Mesh>> &meshes() const { return parts; }
+  const Bounds &bounds() const { return localBounds; }
+  int lodCount() const { return levels; } // of the most detailed submesh
+
+  bool cooked() const { return fromCooked; }
+  double loadMs() const { return ms; } // file → GL, wall clock
+
+  Mesh::Residency residency() const { return keep; }
+  // held by the meshes (see Mesh::cpuBytes / gpuBytes)
+  std::size_t cpuBytes() const;
+  std::size_t gpuBytes() const;
+
+private:
+  std::vector<std::unique_ptr<Mesh>> parts;
+  Bounds localBounds;
+  int levels = 1;
+  Mesh::Residency keep;
+  bool fromCooked = false;
+  double ms = 0.0;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SHAPE_MESH_DATA_H
+#define SHAPE_MESH_DATA_H
+
+#include "shape/Bounds.h"
+#include <assimp/postprocess.h>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+struct Vertex {
+  glm::vec3 pos;
+  glm::vec3 normal;
+  glm::vec2 tex;
+};
+
+/// A model file flattened for upload, with no GL involved (the mesh cooker
+/// links this too): every vertex and index back to back, and a table of the
+/// draw chunks - one per aiMesh - cut out of them. Indices count from their
+/// own submesh's first vertex.
+///
+/// A submesh's index range holds its levels of detail back to back: the full
+/// mesh first, then each simplified level (about half the triangles of the
+/// one before, see MeshSimplifier) over the same vertices.
+struct MeshData {
+  static constexpr unsigned kDefaultImport = aiProcess_Triangulate |
+                                             aiProcess_GenSmoothNormals |
+                                             aiProcess_CalcTangentSpace;
+  static constexpr int kMaxLods = 5;
+  static constexpr std::uint32_t kMinLodTriangles = 64;
+
+  struct Submesh {
+    std::uint32_t firstVertex = 0, vertexCount = 0;
+    std::uint32_t firstIndex = 0, indexCount = 0; // all levels
+    std::uint32_t lodIndexCount[kMaxLods] = {};   // 0 past the last level
+    Bounds bounds;
+
+    int lodCount() const {
+      int n = 0;
+      while (n < kMaxLods && lodIndexCount[n])
+        ++n;
+      return n;
+    }
+  };
+
+  std::vector<Vertex> vertices;
+  std::vector<unsigned> indices;
+  std::vector<Submesh> submeshes;
+  Bounds bounds; // union of the submeshes
+
+  /// loads <path> and builds its levels of detail. OBJ files with the
+  /// default flags go through ObjLoader, everything else (or an OBJ it can't
+  /// read) through Assimp; throws std::runtime_error if neither can.
+  static MeshData import(const std::string &path,
+                         unsigned importFlags = kDefaultImport);
+
+  /// just the Assimp import, without levels of detail
+  static MeshData importAssimp(const std::string &path,
+                               unsigned importFlags = kDefaultImport);
+
+  /// appends the simplified levels to each submesh (import() does this)
+  void buildLods();
+};
+
+#endif
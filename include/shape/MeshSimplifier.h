@@ -0,0 +1,69 @@
+#ifndef SHAPE_MESH_SIMPLIFIER_H
+#define SHAPE_MESH_SIMPLIFIER_H
+
+#include "shape/MeshData.h"
+#include <array>
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+/// Quadric-error edge collapse (Garland & Heckbert) over one submesh's
+/// triangles. Vertices at the same position collapse together, so seams in
+/// the normals or UVs don't stop it, and every collapse moves a corner onto a
+/// neighbouring existing vertex: a simplified level is just another index
+/// list over the same vertices. Open borders stay where they are, and no
+/// collapse may flip a face.
+class MeshSimplifier {
+public:
+  MeshSimplifier(const Vertex *vertices, std::size_t vertexCount,
+                 const unsigned *indices, std::size_t indexCount);
+
+  /// collapses until at most <triangles> are left (or nothing more can go)
+  /// and returns the remaining triangles. Each call carries on from the
+  /// last, so ask for decreasing counts to get a chain of levels.
+  std::vector<unsigned> simplify(std::size_t triangles);
+
+  std::size_t triangles() const { return alive; }
+
+private:
+  // symmetric 4×4 error matrix, upper triangle
+  struct Quadric {
+    double a[10] = {};
+    void addPlane(const glm::dvec3 &n, double d, double weight);
+    Quadric &operator+=(const Quadric &q);
+    double error(const glm::vec3 &p) const;
+  };
+
+  struct Collapse {
+    double cost;
+    unsigned from, to, stamp;
+    bool operator<(const Collapse &c) const { return cost > c.cost; }
+  };
+
+  unsigned resolve(unsigned v);
+  unsigned groupOf(unsigned v) { return group[resolve(v)]; }
+  bool triAlive(unsigned t);
+  bool contains(unsigned t, unsigned g);
+  std::vector<unsigned> neighbours(unsigned g);
+  bool canCollapse(unsigned from, unsigned to);
+  void pushBest(unsigned g);
+  void collapse(unsigned from, unsigned to);
+
+  const Vertex *verts;
+  std::vector<std::array<unsigned, 3>> tris; // original vertex ids
+  std::vector<unsigned> remap;               // vertex → vertex it moved to
+  std::vector<unsigned> group;               // vertex → its position group
+
+  // per position group
+  std::vector<glm::vec3> pos;
+  std::vector<std::vector<unsigned>> members; // its original vertices
+  std::vector<std::vector<unsigned>> faces;   // triangles touching it
+  std::vector<Quadric> quadric;
+  std::vector<unsigned> stamp; // bumped whenever its neighbourhood changes
+  std::vector<char> locked, gone;
+
+  std::priority_queue<Collapse> heap;
+  std::size_t alive = 0;
+};
+
+#endif
@@ -1,36 +1,51 @@
 #ifndef SHAPE_MODEL_SHAPE_H
 #define SHAPE_MODEL_SHAPE_H
 
-#include "shape/Mesh.h"
+#include "render/StaticBatch.h"
+#include "shape/MeshAsset.h"
 #include "util/Shader.h"
-#include <assimp/scene.h>
 #include <memory>
 #include <string>
 
-class ModelShape : public Renderable {
+/// A placed instance of a model: a reference to shared, immutable mesh data
+/// plus its own transform. Any number of ModelShapes can show one file; it
+/// is imported and uploaded once.
+///
+/// Each view draws one of the asset's levels of detail, picked from the
+/// model's size on screen (see DrawList::screenSize): full detail from
+/// kFullDetailPixels up, one level coarser each time the size halves.
+class ModelShape : public Renderable, public StaticShape {
 public:
+  /// the asset comes from ResourceCache::mesh(path)
   ModelShape(Shader *shader, const std::string &path,
              const glm::mat4 &model = glm::mat4(1.f));
+  ModelShape(Shader *shader, std::shared_ptr<const MeshAsset> asset,
+             const glm::mat4 &model = glm::mat4(1.f));
 
   void render() override;
+  void emit(DrawList &list) override; // one packet per mesh
+  void drawPart(int part) override;   // mesh * MeshData::kMaxLods + level
+  bool collect(std::vector<StaticDraw> &out) const override; // full detail
+
+  void setModel(const glm::mat4 &m) {
+    modelMat = m;
+    worldBounds = asset->bounds().transformed(m);
+    touch();
+  }
 
-  // camera matrices pushed each frame by the renderer
-  void setViewProj(const glm::mat4 &v, const glm::mat4 &p,
-                   const glm::vec3 &eye);
-
-  void setModel(const glm::mat4 &m) { modelMat = m; }
+  Bounds bounds() const override { return worldBounds; }
 
 private:
-  void loadNode(const aiNode *, const aiScene *, Shader *);
+  static constexpr float kFullDetailPixels = 512.f;
 
-  std::vector<std::unique_ptr<Mesh>> meshes;
-  glm::mat4 modelMat;
+  int detailFor(float pixels) const;
 
-  // per‑frame
-  glm::mat4 view{1.f}, proj{1.f};
-  glm::vec3 eye{0.f};
+  std::shared_ptr<const MeshAsset> asset;
+  glm::mat4 modelMat;
+  Bounds worldBounds; // the asset's bounds under modelMat
 
   Shader *shader{nullptr};
+  Shader::Uniform<glm::mat4> uModel;
 
 public:
   Shader *getShader() const // read‑only accessor
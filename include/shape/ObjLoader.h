@@ -0,0 +1,22 @@
+#ifndef SHAPE_OBJ_LOADER_H
+#define SHAPE_OBJ_LOADER_H
+
+#include "shape/MeshData.h"
+#include <string>
+
+/// Wavefront OBJ straight into a MeshData, without Assimp. The file is
+/// mapped and cut into line-aligned chunks that are parsed in parallel
+/// (std::from_chars); the chunks are then stitched together, polygons
+/// fanned into triangles and identical v/vt/vn corners merged into one
+/// vertex. Files without normals get smooth ones (area-weighted over every
+/// face at a position), like Assimp's GenSmoothNormals.
+///
+/// A new submesh starts at every "o", "g" or "usemtl" that follows some
+/// faces, as Assimp splits them. Materials, lines and points are ignored.
+class ObjLoader {
+public:
+  /// throws std::runtime_error if the file can't be read or has no faces
+  static MeshData load(const std::string &path);
+};
+
+#endif
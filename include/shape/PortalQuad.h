@@ -1,8 +1,10 @@
 #ifndef SHAPE_PORTAL_QUAD_H
 #define SHAPE_PORTAL_QUAD_H
 
+#include "render/GeometryArena.h"
 #include "shape/GLShape.h"
 #include "shape/Renderable.h"
+#include "util/Shader.h"
 #include <glm/glm.hpp>
 
 class PortalQuad : public GLShape, public Renderable {
@@ -11,12 +13,8 @@ public:
              float sx, float sy);
   ~PortalQuad() = default;
 
-  void setViewProj(const glm::mat4 &v, const glm::mat4 &p) {
-    view = v;
-    proj = p;
-  }
-
   void setPortalVP(const glm::mat4 &m) { portalVP = m; }
+  const glm::mat4 &getPortalVP() const { return portalVP; }
 
   void render() override;
 
@@ -26,7 +24,10 @@ public:
   glm::vec3 c() const;
 
   const glm::mat4 &model() const { return modelMat; }
-  void setModel(const glm::mat4 &m) { modelMat = m; }
+  void setModel(const glm::mat4 &m) {
+    modelMat = m;
+    touch();
+  }
 
   float width() const { return halfW * 2.0f; }
   float height() const { return halfH * 2.0f; }
@@ -34,9 +35,10 @@ public:
   float halfHeight() const { return halfH; }
 
 private:
+  GeometryBlock geometry;
   glm::mat4 modelMat;
-  glm::mat4 view{1.f}, proj{1.f};
   glm::mat4 portalVP{1.f};
+  Shader::Uniform<glm::mat4> uModel, uPortalVP;
 
   float halfW{}, halfH{};
 };
@@ -3,6 +3,9 @@
 #ifndef RENDERABLE_H
 #define RENDERABLE_H
 
+#include "shape/Bounds.h"
+
+class DrawList;
 
 /// Abstract class (interface) representing an object-to-render.
 /// All shapes should public-inherit this class.
@@ -15,6 +18,28 @@ public:
     virtual ~Renderable() noexcept = 0;
 
     virtual void render() = 0;
+
+    /// World-space bounds, used to cull the shape from views that can't see
+    /// it. Empty (the default) means "always draw".
+    virtual Bounds bounds() const;
+
+    /// Add this shape's draws to a sorted draw list. The default adds one
+    /// packet that is drawn with render(); shapes that expose their program,
+    /// texture and VAO let the list batch them and only draw in drawPart().
+    virtual void emit(DrawList & list);
+
+    /// Issue draw <part> with the emitted state already bound.
+    virtual void drawPart(int part);
+
+    /// Goes up whenever the shape moves or otherwise changes how it looks,
+    /// so views of it drawn earlier can tell they are out of date.
+    unsigned changeSerial() const { return changes; }
+
+protected:
+    void touch() { ++changes; }
+
+private:
+    unsigned changes = 0;
 };
 
 
@@ -1,28 +1,24 @@
 #pragma once
+#include "render/GeometryArena.h"
+#include "shape/GLShape.h"
 #include "shape/Renderable.h"
 #include "shape/Texture.h"
-#include "shape/TexturedQuad.h"
 #include "util/Shader.h"
-#include <array>
 #include <memory>
 
-class Skybox : public Renderable {
+/// Cube-mapped sky: one unit cube around the eye, rotated with the view but
+/// never translated, and projected onto the far plane (depth 1.0). It is not
+/// cell geometry; the renderer draws a cell's sky once per view, after the
+/// opaque geometry, so early-z rejects every pixel something already covers.
+class Skybox : public GLShape, public Renderable {
 public:
-  Skybox(Shader *sh,
-         const std::array<std::shared_ptr<Texture2D>, 6> &faceTextures);
-
-  void setViewProj(const glm::mat4 &v, const glm::mat4 &p) {
-    for (auto &face : faces)
-      face->setViewProj(v, p);
-  }
-
+  Skybox(Shader *sh, std::shared_ptr<TextureCube> cubemap);
   void render() override;
 
-  const std::array<std::shared_ptr<TexturedQuad>, 6> &getFaces() const {
-    return faces;
-  }
-  std::array<std::shared_ptr<TexturedQuad>, 6> &getFaces() { return faces; }
+  const std::shared_ptr<TextureCube> &cubemap() const { return sky; }
 
 private:
-  std::array<std::shared_ptr<TexturedQuad>, 6> faces;
+  GeometryBlock geometry;
+  std::shared_ptr<TextureCube> sky;
+  Shader::Uniform<GLint> uSky;
 };
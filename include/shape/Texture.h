@@ -2,8 +2,12 @@
 #define UTIL_TEXTURE_H
 #include <GL/glext.h>
 #include <glad/glad.h>
+#include "util/GLState.h"
+#include <array>
+#include <cstddef>
 #include <string>
 #include <utility>
+#include <vector>
 
 class Texture2D {
 public:
@@ -19,41 +23,163 @@ public:
   }
 
   void bind(int unit = 0) const {
-    if (id == 0)
-      upload();
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLState::inst().activeTexture(GL_TEXTURE0 + unit);
+    GLState::inst().bindTexture(GL_TEXTURE_2D, handle());
+  }
 
-    /* apply current global value every bind (cheap, driver caches) */
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, s_aniso);
+  /// GL name for callers that bind it themselves (uploads on first use and
+  /// brings the anisotropy up to date, which binds it to the active unit).
+  /// While TextureStreamer still has the pixels this is the 1×1 placeholder.
+  GLuint handle() const {
+    if (id == 0 && !streamed)
+      upload();
+    if (id == 0)
+      return placeholder();
+    if (appliedAniso != s_aniso) {
+      GLState::inst().bindTexture(GL_TEXTURE_2D, id);
+      applyAnisotropy();
+    }
+    return id;
   }
 
+  bool resident() const { return id != 0; }
+  const std::string &path() const { return file; }
+
+  /// creates the texture from a DDS (BC1/BC3/BC7 with its mip chain, see
+  /// DdsImage) instead of the source; false if the file can't be used here
+  bool uploadCompressed(const std::string &ddsPath);
+  bool compressed() const { return isCompressed; }
+  // GPU memory of all mip levels, and what it would be as plain RGBA8
+  std::size_t gpuBytes() const { return vramBytes; }
+  std::size_t rgbaBytes() const { return rawBytes; }
+
   ~Texture2D() {
     if (id)
-      glDeleteTextures(1, &id);
+      GLState::inst().deleteTextures(1, &id);
   }
 
   Texture2D(const Texture2D &) = delete;
   Texture2D &operator=(const Texture2D &) = delete;
-  Texture2D(Texture2D &&rhs) noexcept { id = std::exchange(rhs.id, 0); }
+  Texture2D(Texture2D &&rhs) noexcept {
+    id = std::exchange(rhs.id, 0);
+    appliedAniso = rhs.appliedAniso;
+    vramBytes = rhs.vramBytes;
+    rawBytes = rhs.rawBytes;
+    isCompressed = rhs.isCompressed;
+  }
   Texture2D &operator=(Texture2D &&rhs) noexcept {
     if (this != &rhs) {
       if (id)
-        glDeleteTextures(1, &id);
+        GLState::inst().deleteTextures(1, &id);
       id = std::exchange(rhs.id, 0);
+      appliedAniso = rhs.appliedAniso;
+      vramBytes = rhs.vramBytes;
+      rawBytes = rhs.rawBytes;
+      isCompressed = rhs.isCompressed;
     }
     return *this;
   }
 
 private:
-  void upload() const;
+  friend class TextureStreamer;
+
+  void upload() const; // decode + upload right now, on this thread
+  // creates the GL texture; <pixels> is an offset when a PBO is bound
+  void create(int w, int h, GLenum fmt, const void *pixels) const;
+  static GLuint placeholder(); // 1×1 white, shared
+  void setSampling() const;     // filter + wrap, with the texture bound
+
+  // texture-object state: only re-sent when the global value changed
+  void applyAnisotropy() const {
+    if (appliedAniso != s_aniso) {
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, s_aniso);
+      appliedAniso = s_aniso;
+    }
+  }
 
   mutable GLuint id = 0;
+  mutable float appliedAniso = 0.f;
   std::string file;
   bool clampWrap = false;
+  bool streamed = false; // queued with TextureStreamer: never load inline
+  bool isCompressed = false;
+  mutable std::size_t vramBytes = 0, rawBytes = 0;
 
   static float s_maxAniso;
   static float s_aniso;
 };
 
+/// All layers of a GL_TEXTURE_2D_ARRAY share one size, so every image is
+/// scaled to layerSize × layerSize when the array is built (on the GPU, by
+/// blitting). Layer i is paths[i]. Loaded eagerly: needs a current context.
+class Texture2DArray {
+public:
+  explicit Texture2DArray(const std::vector<std::string> &paths,
+                          int layerSize = 512);
+  ~Texture2DArray() {
+    if (id)
+      GLState::inst().deleteTextures(1, &id);
+  }
+
+  Texture2DArray(const Texture2DArray &) = delete;
+  Texture2DArray &operator=(const Texture2DArray &) = delete;
+
+  void bind(int unit = 0) const {
+    GLState::inst().activeTexture(GL_TEXTURE0 + unit);
+    GLState::inst().bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    applyAnisotropy();
+  }
+
+  GLuint handle() const {
+    if (appliedAniso != Texture2D::anisotropy()) {
+      GLState::inst().bindTexture(GL_TEXTURE_2D_ARRAY, id);
+      applyAnisotropy();
+    }
+    return id;
+  }
+
+  int layers() const { return layerCount; }
+
+private:
+  void applyAnisotropy() const {
+    if (appliedAniso != Texture2D::anisotropy()) {
+      appliedAniso = Texture2D::anisotropy();
+      glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY,
+                      appliedAniso);
+    }
+  }
+
+  GLuint id = 0;
+  int layerCount = 0;
+  mutable float appliedAniso = 0.f;
+};
+
+/// GL_TEXTURE_CUBE_MAP, loaded eagerly (needs a current context). Either six
+/// square face images in GL order (+X, -X, +Y, -Y, +Z, -Z), or one
+/// equirectangular panorama resampled into faceSize × faceSize faces.
+class TextureCube {
+public:
+  explicit TextureCube(const std::array<std::string, 6> &faces);
+  TextureCube(const std::string &equirect, int faceSize = 512);
+  ~TextureCube() {
+    if (id)
+      GLState::inst().deleteTextures(1, &id);
+  }
+
+  TextureCube(const TextureCube &) = delete;
+  TextureCube &operator=(const TextureCube &) = delete;
+
+  void bind(int unit = 0) const {
+    GLState::inst().activeTexture(GL_TEXTURE0 + unit);
+    GLState::inst().bindTexture(GL_TEXTURE_CUBE_MAP, id);
+  }
+
+  GLuint handle() const { return id; }
+
+private:
+  void finish(); // mipmaps + sampling state, with the cube map bound
+
+  GLuint id = 0;
+};
+
 #endif
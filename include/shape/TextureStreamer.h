@@ -0,0 +1,95 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Texture2D;
+
+/// an image decoded to RGBA8; pixels is null when the file failed to load
+struct DecodedImage {
+  int width = 0, height = 0;
+  std::shared_ptr<unsigned char> pixels;
+
+  std::size_t bytes() const { return std::size_t(width) * height * 4; }
+};
+
+/// upload traffic of the last pump() (see TextureStreamer::frameStats)
+struct TextureStreamStats {
+  int pending = 0;        // requested textures not resident yet
+  int uploaded = 0;       // textures that went up last frame
+  std::size_t bytes = 0;  // ... and their size
+};
+
+/// Gets Texture2D pixels onto the GPU without stalling the render loop.
+/// A requested file is decoded straight away by a small worker pool; once per
+/// frame pump() (GL thread) copies finished images into a ring of pixel-unpack
+/// buffers and creates the textures from there, spending at most budget()
+/// bytes a frame (but always at least one image). Until then a texture binds
+/// a 1×1 placeholder.
+class TextureStreamer {
+public:
+  static TextureStreamer &inst() {
+    static TextureStreamer s;
+    return s;
+  }
+
+  TextureStreamer(const TextureStreamer &) = delete;
+  TextureStreamer &operator=(const TextureStreamer &) = delete;
+  ~TextureStreamer();
+
+  /// queues <tex> for decoding; it stays on the placeholder until uploaded
+  void request(const std::shared_ptr<Texture2D> &tex);
+
+  /// decodes <path> to RGBA8 on the pool, for loaders that wait for it
+  std::future<DecodedImage> decode(const std::string &path);
+
+  /// uploads decoded images within the byte budget; call once per frame
+  void pump();
+
+  void setBudget(std::size_t bytes) { frameBudget = bytes; }
+  std::size_t budget() const { return frameBudget; }
+  const TextureStreamStats &frameStats() const { return stats; }
+
+private:
+  static constexpr int kRing = 3;
+
+  struct Ready {
+    std::weak_ptr<Texture2D> texture;
+    std::string path;
+    DecodedImage image;
+  };
+
+  TextureStreamer();
+
+  void submit(std::function<void()> job);
+  void work();
+  void upload(Texture2D &tex, const DecodedImage &img);
+
+  std::vector<std::thread> workers;
+  std::mutex jobMutex;
+  std::condition_variable jobReady;
+  std::deque<std::function<void()>> jobs;
+  bool stopping = false;
+
+  std::mutex readyMutex;
+  std::deque<Ready> ready; // decoded, waiting for pump()
+
+  std::array<GLuint, kRing> pbos{};
+  int nextPbo = 0;
+  std::size_t frameBudget = 8u << 20;
+  std::atomic<int> pending{0};
+  TextureStreamStats stats;
+};
+
+#endif // TEXTURE_STREAMER_H
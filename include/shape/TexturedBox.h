@@ -7,15 +7,14 @@
 #include <glm/glm.hpp>
 #include <memory>
 
-class TexturedBox : public Renderable {
+class TexturedBox : public Renderable, public StaticShape {
 public:
   TexturedBox(Shader *sh, const glm::vec3 &C, float W, float H, float D,
               std::shared_ptr<Texture2D> tex, bool tile = false);
   void render() override;
-  void setViewProj(const glm::mat4 &v, const glm::mat4 &p) {
-    view = v;
-    proj = p;
-  }
+  void emit(DrawList &list) override; // the faces, as separate packets
+  Bounds bounds() const override; // union of the faces
+  bool collect(std::vector<StaticDraw> &out) const override;
 
   const std::array<std::unique_ptr<TexturedQuad>, 6> &getFaces() const {
     return faces;
@@ -23,5 +22,4 @@ public:
 
 private:
   std::array<std::unique_ptr<class TexturedQuad>, 6> faces;
-  glm::mat4 view{1.f}, proj{1.f};
 };
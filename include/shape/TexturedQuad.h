@@ -1,13 +1,16 @@
 #ifndef SHAPE_TEXTURED_QUAD_H
 #define SHAPE_TEXTURED_QUAD_H
+#include "render/GeometryArena.h"
+#include "render/StaticBatch.h"
 #include "shape/GLShape.h"
 #include "shape/Texture.h"
+#include "util/Shader.h"
 #include <GL/gl.h>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/glm.hpp>
 #include <memory>
 
-class TexturedQuad : public GLShape, public Renderable {
+class TexturedQuad : public GLShape, public Renderable, public StaticShape {
 public:
   /// xyz = quad center,  nx ny nz = normal,  sx,sy = half‑size in local axes
   TexturedQuad(Shader *sh, const glm::vec3 &pos, const glm::vec3 &normal,
@@ -21,24 +24,42 @@ public:
   TexturedQuad(Shader *sh, std::shared_ptr<Texture2D> tex,
                const glm::mat4 &model = glm::mat4(1.f));
 
-  void setViewProj(const glm::mat4 &v, const glm::mat4 &p) {
-    view = v;
-    proj = p;
-  }
-
   void render() override;
+  void emit(DrawList &list) override;
+  void drawPart(int) override;
+  bool collect(std::vector<StaticDraw> &out) const override;
   glm::vec3 normal() const { return N; }
   float planeD() const { return -glm::dot(N, centre); }
   const glm::mat4 &model() const { return modelMat; } // world transform
   const glm::vec3 &c() const { return centre; }       // world position
   void overrideVAO(GLuint customVao) { vao = customVao; }
-  void setModel(const glm::mat4 &m) { modelMat = m; }
+  void setModel(const glm::mat4 &m) {
+    modelMat = m;
+    worldBounds = localBounds.transformed(m);
+    touch();
+  }
+
+  Bounds bounds() const override { return worldBounds; }
+  // for quads whose vertex data comes from overrideVAO
+  void setLocalBounds(const Bounds &b) {
+    localBounds = b;
+    worldBounds = b.transformed(modelMat);
+  }
 
 private:
+  void resolveUniforms();
+  // the arena page's, or the one set by overrideVAO
+  GLuint vertexArray() const {
+    return geometry ? geometry.vertexArray() : vao;
+  }
+
+  GeometryBlock geometry; // 4 corners, 6 indices
   std::shared_ptr<Texture2D> texture;
+  Shader::Uniform<glm::mat4> uModel;
+  Shader::Uniform<GLint> uTex0;
 
   glm::mat4 modelMat;
-  glm::mat4 view{1.f}, proj{1.f};
+  Bounds localBounds, worldBounds;
 
   glm::vec3 centre{};
   glm::vec3 N{};
@@ -0,0 +1,255 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <array>
+
+#include <glad/glad.h>
+
+/// state-change traffic over one frame (see GLState::frameStats)
+struct GLStateStats {
+  int issued = 0;  // calls that reached the driver
+  int skipped = 0; // calls dropped because the state was already set
+};
+
+/// Shadow copy of the GL state the renderer touches. Every bind / enable /
+/// depth-stencil call goes through here, and a call that would not change
+/// anything never reaches the driver.
+///
+/// Anything that talks to GL directly (ImGui's backend, the window setup)
+/// leaves the shadow stale, so the whole cache is dropped once per frame in
+/// beginFrame(); until a value is set again it counts as unknown and the next
+/// call is always issued.
+class GLState {
+public:
+  static GLState &inst() {
+    static GLState s;
+    return s;
+  }
+
+  GLState(const GLState &) = delete;
+  GLState &operator=(const GLState &) = delete;
+
+  // forget everything (call after code that bypasses the cache)
+  void invalidate() { shadow = {}; }
+
+  void beginFrame() {
+    lastFrame = frame;
+    frame = {};
+    invalidate();
+  }
+  const GLStateStats &frameStats() const { return lastFrame; }
+
+  /* -------- objects -------- */
+  void useProgram(GLuint p) {
+    if (change(shadow.program, p))
+      glUseProgram(p);
+  }
+
+  void bindVertexArray(GLuint v) {
+    if (change(shadow.vao, v))
+      glBindVertexArray(v);
+  }
+
+  void activeTexture(GLenum unit) {
+    if (change(shadow.activeUnit, int(unit - GL_TEXTURE0)))
+      glActiveTexture(unit);
+  }
+
+  // binds on the active unit, like glBindTexture
+  void bindTexture(GLenum target, GLuint tex) {
+    const int slot = targetSlot(target);
+    const auto &unit = shadow.activeUnit;
+    if (slot < 0 || !unit.known || unit.value >= kUnits) {
+      issue();
+      glBindTexture(target, tex);
+      return;
+    }
+    if (change(shadow.textures[unit.value][slot], tex))
+      glBindTexture(target, tex);
+  }
+
+  void bindTexture(int unit, GLenum target, GLuint tex) {
+    activeTexture(GL_TEXTURE0 + unit);
+    bindTexture(target, tex);
+  }
+
+  // GL_FRAMEBUFFER sets both the draw and the read binding
+  void bindFramebuffer(GLenum target, GLuint fbo) {
+    if (target == GL_FRAMEBUFFER) {
+      auto &draw = shadow.drawFbo, &read = shadow.readFbo;
+      if (draw.known && read.known && draw.value == fbo && read.value == fbo) {
+        ++frame.skipped;
+        return;
+      }
+      shadow.drawFbo = {fbo, true};
+      shadow.readFbo = {fbo, true};
+      issue();
+    } else if (!change(target == GL_READ_FRAMEBUFFER ? shadow.readFbo
+                                                     : shadow.drawFbo,
+                       fbo)) {
+      return;
+    }
+    glBindFramebuffer(target, fbo);
+  }
+
+  // deleting an object unbinds it, and GL may hand the name out again
+  void deleteTextures(GLsizei n, const GLuint *ids) {
+    for (GLsizei i = 0; i < n; ++i)
+      for (auto &unit : shadow.textures)
+        for (auto &t : unit)
+          forget(t, ids[i]);
+    glDeleteTextures(n, ids);
+  }
+  void deleteVertexArrays(GLsizei n, const GLuint *ids) {
+    for (GLsizei i = 0; i < n; ++i)
+      forget(shadow.vao, ids[i]);
+    glDeleteVertexArrays(n, ids);
+  }
+  void deleteFramebuffers(GLsizei n, const GLuint *ids) {
+    for (GLsizei i = 0; i < n; ++i) {
+      forget(shadow.drawFbo, ids[i]);
+      forget(shadow.readFbo, ids[i]);
+    }
+    glDeleteFramebuffers(n, ids);
+  }
+  // a program in use is only flagged for deletion, so the binding stays
+  void deleteProgram(GLuint p) { glDeleteProgram(p); }
+
+  /* -------- rasteriser -------- */
+  void viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    if (change(shadow.viewport, {x, y, w, h}))
+      glViewport(x, y, w, h);
+  }
+
+  void scissor(GLint x, GLint y, GLsizei w, GLsizei h) {
+    if (change(shadow.scissor, {x, y, w, h}))
+      glScissor(x, y, w, h);
+  }
+
+  void enable(GLenum cap) { set(cap, true); }
+  void disable(GLenum cap) { set(cap, false); }
+  void set(GLenum cap, bool on) {
+    const int slot = capSlot(cap);
+    if (slot >= 0 && !change(shadow.caps[slot], on))
+      return;
+    if (slot < 0)
+      issue();
+    if (on)
+      glEnable(cap);
+    else
+      glDisable(cap);
+  }
+
+  void colorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+    if (change(shadow.colorMask, {r, g, b, a}))
+      glColorMask(r, g, b, a);
+  }
+
+  /* -------- depth / stencil -------- */
+  void depthFunc(GLenum f) {
+    if (change(shadow.depthFunc, f))
+      glDepthFunc(f);
+  }
+
+  void depthMask(GLboolean on) {
+    if (change(shadow.depthMask, on))
+      glDepthMask(on);
+  }
+
+  void stencilFunc(GLenum f, GLint ref, GLuint mask) {
+    if (change(shadow.stencilFunc, {GLuint(f), GLuint(ref), mask}))
+      glStencilFunc(f, ref, mask);
+  }
+
+  void stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass) {
+    if (change(shadow.stencilOp, {sfail, dpfail, dppass}))
+      glStencilOp(sfail, dpfail, dppass);
+  }
+
+  void stencilMask(GLuint mask) {
+    if (change(shadow.stencilMask, mask))
+      glStencilMask(mask);
+  }
+
+private:
+  static constexpr int kUnits = 16;
+  static constexpr int kTargets = 4; // see targetSlot
+  static constexpr int kCaps = 6 + 8; // see capSlot
+
+  template <class T> struct Cached {
+    T value{};
+    bool known = false;
+  };
+
+  GLState() = default;
+
+  template <class T> bool change(Cached<T> &c, const T &v) {
+    if (c.known && c.value == v) {
+      ++frame.skipped;
+      return false;
+    }
+    c = {v, true};
+    issue();
+    return true;
+  }
+
+  template <class T> static void forget(Cached<T> &c, GLuint name) {
+    if (c.known && c.value == name)
+      c.value = 0;
+  }
+
+  void issue() { ++frame.issued; }
+
+  static int targetSlot(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_2D_ARRAY:
+      return 1;
+    case GL_TEXTURE_CUBE_MAP:
+      return 2;
+    case GL_TEXTURE_3D:
+      return 3;
+    default:
+      return -1;
+    }
+  }
+
+  static int capSlot(GLenum cap) {
+    switch (cap) {
+    case GL_DEPTH_TEST:
+      return 0;
+    case GL_STENCIL_TEST:
+      return 1;
+    case GL_SCISSOR_TEST:
+      return 2;
+    case GL_CULL_FACE:
+      return 3;
+    case GL_BLEND:
+      return 4;
+    case GL_MULTISAMPLE:
+      return 5;
+    default:
+      if (cap >= GL_CLIP_DISTANCE0 && cap < GL_CLIP_DISTANCE0 + 8)
+        return 6 + int(cap - GL_CLIP_DISTANCE0);
+      return -1;
+    }
+  }
+
+  struct Shadow {
+    Cached<GLuint> program, vao, drawFbo, readFbo;
+    Cached<int> activeUnit;
+    std::array<std::array<Cached<GLuint>, kTargets>, kUnits> textures;
+    Cached<std::array<GLint, 4>> viewport, scissor;
+    std::array<Cached<bool>, kCaps> caps;
+    Cached<std::array<GLboolean, 4>> colorMask;
+    Cached<GLenum> depthFunc;
+    Cached<GLboolean> depthMask;
+    Cached<std::array<GLuint, 3>> stencilFunc, stencilOp;
+    Cached<GLuint> stencilMask;
+  } shadow;
+
+  GLStateStats frame, lastFrame;
+};
+
+#endif // GL_STATE_H
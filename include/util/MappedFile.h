@@ -0,0 +1,71 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Read-only view of a whole file through mmap. Pages are faulted in on
+/// first touch, so nothing is copied until something reads (or GL uploads)
+/// the bytes. A file that can't be opened gives an empty (false) mapping.
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        ptr = static_cast<const unsigned char *>(p);
+        len = std::size_t(st.st_size);
+      }
+    }
+    ::close(fd); // the mapping keeps the file alive
+  }
+  ~MappedFile() { reset(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&rhs) noexcept
+      : ptr(std::exchange(rhs.ptr, nullptr)), len(std::exchange(rhs.len, 0)) {}
+  MappedFile &operator=(MappedFile &&rhs) noexcept {
+    if (this != &rhs) {
+      reset();
+      ptr = std::exchange(rhs.ptr, nullptr);
+      len = std::exchange(rhs.len, 0);
+    }
+    return *this;
+  }
+
+  explicit operator bool() const { return ptr != nullptr; }
+  const unsigned char *data() const { return ptr; }
+  std::size_t size() const { return len; }
+
+  // the mapping is read sequentially once (upload / parse)
+  void adviseSequential() const {
+    if (ptr)
+      ::madvise(const_cast<unsigned char *>(ptr), len, MADV_SEQUENTIAL);
+  }
+
+private:
+  void reset() {
+    if (ptr)
+      ::munmap(const_cast<unsigned char *>(ptr), len);
+    ptr = nullptr;
+    len = 0;
+  }
+
+  const unsigned char *ptr = nullptr;
+  std::size_t len = 0;
+};
+
+#endif
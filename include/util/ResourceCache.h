@@ -1,9 +1,37 @@
 #ifndef RESOURCE_CACHE_H
 #define RESOURCE_CACHE_H
+#include "shape/DdsImage.h"
+#include "shape/MeshAsset.h"
 #include "shape/Texture.h"
+#include "shape/TextureStreamer.h"
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
+
+/// how the model files were loaded so far (see ResourceCache::meshStats)
+struct MeshLoadStats {
+  int assets = 0; // distinct files (per import flags)
+  int cooked = 0; // ... that came from a .cmesh
+  double ms = 0.0; // total load time, file → GL
+};
+
+/// GPU memory of the pooled 2D textures (see ResourceCache::textureMemory)
+struct TextureMemoryStats {
+  int textures = 0;   // resident ones
+  int compressed = 0; // ... that came from a .dds
+  std::size_t bytes = 0;     // actual size, mip chains included
+  std::size_t rgbaBytes = 0; // ... had they all been plain RGBA8
+};
+
+/// what one pooled model holds (see ResourceCache::meshMemory)
+struct MeshMemoryStats {
+  std::string path;
+  bool cpuCopy = false; // loaded with Mesh::Residency::CpuCopy
+  std::size_t cpuBytes = 0;
+  std::size_t gpuBytes = 0; // its share of the GeometryArena
+};
 
 class ResourceCache {
 public:
@@ -12,7 +40,10 @@ public:
     return c;
   }
 
-  /// returns a *shared* texture; loads it the first time only
+  /// returns a *shared* texture. The first request uploads an up-to-date
+  /// block-compressed copy ("<path>.dds", see tools/texcompress) right away;
+  /// otherwise it starts decoding the source in the background (see
+  /// TextureStreamer) and the texture binds a placeholder until then
   std::shared_ptr<Texture2D> texture(const std::string &path,
                                      bool clamp = false) {
     std::string key = clamp ? path + "#clamp" : path;
@@ -22,12 +53,91 @@ public:
       return it->second;
 
     auto tex = std::make_shared<Texture2D>(path, clamp);
+    if (!DdsImage::isFresh(path) ||
+        !tex->uploadCompressed(DdsImage::pathFor(path)))
+      TextureStreamer::inst().request(tex);
     texPool.emplace(key, tex);
     return tex;
   }
 
+  /// shared GPU mesh data for a model file; imported the first time only,
+  /// once per distinct set of Assimp post-processing flags. Only callers
+  /// that read the triangles back ask for a CPU copy, and get an asset of
+  /// their own that keeps one.
+  std::shared_ptr<const MeshAsset>
+  mesh(const std::string &path,
+       unsigned importFlags = MeshData::kDefaultImport,
+       Mesh::Residency residency = Mesh::Residency::GpuOnly) {
+    std::string key = path + '#' + std::to_string(importFlags);
+    if (residency == Mesh::Residency::CpuCopy)
+      key += "#cpu";
+
+    auto it = meshPool.find(key);
+    if (it != meshPool.end())
+      return it->second;
+
+    auto asset =
+        std::make_shared<const MeshAsset>(path, importFlags, residency);
+    meshPool.emplace(key, asset);
+    ++meshLoads.assets;
+    meshLoads.cooked += asset->cooked();
+    meshLoads.ms += asset->loadMs();
+    return asset;
+  }
+  const MeshLoadStats &meshStats() const { return meshLoads; }
+
+  std::vector<MeshMemoryStats> meshMemory() const {
+    std::vector<MeshMemoryStats> out;
+    for (const auto &[key, asset] : meshPool)
+      out.push_back({key.substr(0, key.find('#')),
+                     asset->residency() == Mesh::Residency::CpuCopy,
+                     asset->cpuBytes(), asset->gpuBytes()});
+    return out;
+  }
+
+  TextureMemoryStats textureMemory() const {
+    TextureMemoryStats s;
+    for (const auto &[key, tex] : texPool) {
+      if (!tex->resident())
+        continue;
+      ++s.textures;
+      s.compressed += tex->compressed();
+      s.bytes += tex->gpuBytes();
+      s.rgbaBytes += tex->rgbaBytes();
+    }
+    return s;
+  }
+
+  /// shared cube map from six faces (+X, -X, +Y, -Y, +Z, -Z)
+  std::shared_ptr<TextureCube>
+  cubemap(const std::array<std::string, 6> &faces) {
+    std::string key;
+    for (auto &f : faces)
+      key += f + '|';
+    return cube(key, [&] { return std::make_shared<TextureCube>(faces); });
+  }
+
+  /// shared cube map resampled from an equirectangular panorama
+  std::shared_ptr<TextureCube> cubemap(const std::string &equirect,
+                                       int faceSize = 512) {
+    return cube(equirect + '#' + std::to_string(faceSize), [&] {
+      return std::make_shared<TextureCube>(equirect, faceSize);
+    });
+  }
+
 private:
+  template <class Make>
+  std::shared_ptr<TextureCube> cube(const std::string &key, Make make) {
+    auto it = cubePool.find(key);
+    if (it != cubePool.end())
+      return it->second;
+    return cubePool.emplace(key, make()).first->second;
+  }
+
   std::map<std::string, std::shared_ptr<Texture2D>> texPool;
+  std::map<std::string, std::shared_ptr<TextureCube>> cubePool;
+  std::map<std::string, std::shared_ptr<const MeshAsset>> meshPool;
+  MeshLoadStats meshLoads;
 };
 
 #endif
@@ -3,6 +3,7 @@
 
 #include "portal/Portal.h"
 #include "portal/Scene.h"
+#include "shape/InstancedBoxes.h"
 #include "shape/ModelShape.h"
 #include "shape/PortalQuad.h"
 #include "shape/Skybox.h"
@@ -21,6 +22,7 @@ public:
     scene = std::move(result.scene);
     animatedTeapot = std::move(result.animatedTeapot);
     fallingCubes = std::move(result.fallingCubes);
+    cubeField = std::move(result.cubeField);
 
     const float PW = 4, PH = 0.1f;
     glm::vec3 smallSize{1, 1.5f, 0.1f};
@@ -95,8 +97,7 @@ public:
       model = glm::rotate(model, fc.angle, fc.rotationAxis);
       model = glm::scale(model, glm::vec3(2.0f));
 
-      for (auto &quad : fc.box->getFaces())
-        quad->setModel(model);
+      cubeField->setModel(fc.instance, model);
     }
   }
 
@@ -108,7 +109,7 @@ public:
     p.model = std::make_shared<ModelShape>(
         ShaderStore::inst().phong(), "rsrc/models/sphere.obj",
         glm::scale(glm::mat4(1.0f), glm::vec3(0.1f)));
-    cell->getGeometry().push_back(p.model);
+    cell->add(p.model);
     projectiles.push_back(std::move(p));
   }
 
@@ -127,7 +128,7 @@ private:
   float projectileSpeed{8.0f};
 
   struct FallingCube {
-    std::shared_ptr<TexturedBox> box;
+    int instance; // in cubeField
     float x, y, z;
     float angle;
     float fallSpeed;
@@ -136,18 +137,21 @@ private:
   };
 
   std::vector<FallingCube> fallingCubes;
+  std::shared_ptr<InstancedBoxes> cubeField; // every falling cube, one draw
+  static constexpr int kFallingCubes = 100;
 
   struct SceneBuild {
     std::unique_ptr<Scene> scene;
     std::shared_ptr<ModelShape> animatedTeapot;
     std::vector<FallingCube> fallingCubes;
+    std::shared_ptr<InstancedBoxes> cubeField;
   };
 
   static SceneBuild makePortalDemoScene() {
     SceneBuild out;
     out.scene = std::make_unique<Scene>();
     // shaders & textures
-    Shader *skySh = ShaderStore::inst().textured();
+    Shader *skySh = ShaderStore::inst().skybox();
     Shader *texSh = ShaderStore::inst().textured();
     Shader *phong = ShaderStore::inst().phong();
     Shader *portalSh = ShaderStore::inst().portal_quad();
@@ -163,51 +167,41 @@ private:
     glm::vec3 hall(0, 0, 120.f);
     glm::vec3 bigB = bigA + hall + glm::vec3(0, 0, bigSize.z * 0.5f);
 
+    // the hall behind the big portal is its own cell, so it can have its
+    // own sky
     Cell *cell = out.scene->createCell();
+    Cell *hallCell = out.scene->createCell();
     out.scene->setViewpoint(cell);
 
-    // sky + floor
-    auto skyA = std::make_shared<Skybox>(
-        skySh,
-        std::array{
-            ResourceCache::inst().texture("rsrc/textures/px.png", true),
-            ResourceCache::inst().texture("rsrc/textures/nx.png", true),
-            ResourceCache::inst().texture("rsrc/textures/ny.png", true),
-            ResourceCache::inst().texture("rsrc/textures/py.png", true),
-            ResourceCache::inst().texture("rsrc/textures/pz.png", true),
-            ResourceCache::inst().texture("rsrc/textures/nz.png", true)});
-    cell->getGeometry().push_back(skyA);
-    cell->getGeometry().push_back(std::make_shared<TexturedBox>(
+    // sky + floor (faces in GL order; this set names +Y "ny" and +Z "nz")
+    cell->setSky(std::make_shared<Skybox>(
+        skySh, ResourceCache::inst().cubemap(
+                   {"rsrc/textures/px.png", "rsrc/textures/nx.png",
+                    "rsrc/textures/ny.png", "rsrc/textures/py.png",
+                    "rsrc/textures/nz.png", "rsrc/textures/pz.png"})));
+    cell->addStatic(std::make_shared<TexturedBox>(
         texSh, glm::vec3(0, PH * 0.5f, 0), PW, PH, PD, chk, true));
 
     // Suzanne + teapot
-    cell->getGeometry().push_back(std::make_shared<ModelShape>(
+    cell->addStatic(std::make_shared<ModelShape>(
         phong, "rsrc/models/suzanne.obj",
         glm::translate(glm::mat4(1), glm::vec3(0, PH + 0.2f, 0)) *
             glm::scale(glm::mat4(1), glm::vec3(0.2f))));
     out.animatedTeapot = std::make_shared<ModelShape>(
         phong, "rsrc/models/teapot.obj", glm::mat4(1));
-    cell->getGeometry().push_back(out.animatedTeapot);
+    cell->add(out.animatedTeapot);
 
     // second sky+floor
-    auto skyB = std::make_shared<Skybox>(
-        skySh,
-        std::array{
-            ResourceCache::inst().texture("rsrc/textures/px1.png", true),
-            ResourceCache::inst().texture("rsrc/textures/nx1.png", true),
-            ResourceCache::inst().texture("rsrc/textures/ny1.png", true),
-            ResourceCache::inst().texture("rsrc/textures/py1.png", true),
-            ResourceCache::inst().texture("rsrc/textures/pz1.png", true),
-            ResourceCache::inst().texture("rsrc/textures/nz1.png", true)});
-    for (auto &f : skyB->getFaces()) {
-      f->setModel(glm::translate(glm::mat4(1), hall) * f->model());
-      cell->getGeometry().push_back(f);
-    }
-    cell->getGeometry().push_back(std::make_shared<TexturedBox>(
+    hallCell->setSky(std::make_shared<Skybox>(
+        skySh, ResourceCache::inst().cubemap(
+                   {"rsrc/textures/px1.png", "rsrc/textures/nx1.png",
+                    "rsrc/textures/ny1.png", "rsrc/textures/py1.png",
+                    "rsrc/textures/nz1.png", "rsrc/textures/pz1.png"})));
+    hallCell->addStatic(std::make_shared<TexturedBox>(
         texSh, glm::vec3(0, PH * 0.5f, 0) + hall, PW, PH, PD, chk, true));
 
     // add main volumetric portal
-    addVolumetricPortal(cell, portalSh, bigA, bigB, bigSize);
+    addVolumetricPortal(cell, hallCell, portalSh, bigA, bigB, bigSize);
 
     // add two smaller side portals
     // ─── two small side‐portals whose LARGE faces face each other ────
@@ -256,8 +250,8 @@ private:
                     glm::vec3(0, 1, 0));
     quadR->setModel(modelR);
 
-    cell->getGeometry().push_back(quadL);
-    cell->getGeometry().push_back(quadR);
+    cell->add(quadL);
+    cell->add(quadR);
 
     // 2) Build ML/MR *exactly* the same way:
     glm::mat4 ML =
@@ -282,14 +276,15 @@ private:
     std::mt19937 rng{std::random_device{}()};
     std::uniform_real_distribution<float> dXZ(-45.f, 45.f), dY(40.f, 50.f),
         dSp(5.f, 10.f), dRot(2.f, 6.f), dA(-1.f, 1.f);
-    std::vector<std::shared_ptr<Texture2D>> cubeTexs;
-    for (auto &p : std::vector<std::string>{
-             "rsrc/textures/adachi.png", "rsrc/textures/awesomeface.png",
-             "rsrc/textures/box.jpg", "rsrc/textures/cobblestone.png",
-             "rsrc/textures/dirt.png", "rsrc/textures/metal.jpg"})
-      cubeTexs.push_back(ResourceCache::inst().texture(p, true));
-
-    for (int i = 0; i < 100; ++i) {
+    auto cubeTexs = std::make_shared<Texture2DArray>(std::vector<std::string>{
+        "rsrc/textures/adachi.png", "rsrc/textures/awesomeface.png",
+        "rsrc/textures/box.jpg", "rsrc/textures/cobblestone.png",
+        "rsrc/textures/dirt.png", "rsrc/textures/metal.jpg"});
+    out.cubeField = std::make_shared<InstancedBoxes>(
+        ShaderStore::inst().instanced(), glm::vec3(0.5f), cubeTexs);
+    hallCell->add(out.cubeField);
+
+    for (int i = 0; i < kFallingCubes; ++i) {
       FallingCube fc;
       fc.x = dXZ(rng) + hall.x;
       fc.z = dXZ(rng) + hall.z;
@@ -298,15 +293,10 @@ private:
       fc.rotationSpeed = dRot(rng);
       fc.rotationAxis = glm::normalize(glm::vec3(dA(rng), dA(rng), dA(rng)));
       fc.angle = 0.f;
-      fc.box =
-          std::make_shared<TexturedBox>(texSh, glm::vec3(0), 0.5f, 0.5f, 0.5f,
-                                        cubeTexs[rng() % cubeTexs.size()]);
       glm::mat4 m = glm::translate(glm::mat4(1), glm::vec3(fc.x, fc.y, fc.z));
       m = glm::rotate(m, fc.angle, fc.rotationAxis);
       m = glm::scale(m, glm::vec3(2.f));
-      for (auto &q : fc.box->getFaces())
-        q->setModel(m);
-      cell->getGeometry().push_back(fc.box);
+      fc.instance = out.cubeField->add(m, int(rng() % cubeTexs->layers()));
       out.fallingCubes.push_back(fc);
     }
 
@@ -502,7 +492,8 @@ private:
   }
 
   // —— Volumetric portal builder — swap only the ±X faces ————————
-  static void addVolumetricPortal(Cell *cell, Shader *portalSh,
+  // A side lives in <cell>, B side in <dstCell>
+  static void addVolumetricPortal(Cell *cell, Cell *dstCell, Shader *portalSh,
                                   glm::vec3 centerA, glm::vec3 centerB,
                                   glm::vec3 size) {
     // half-extents
@@ -543,16 +534,16 @@ private:
       auto surfB = std::make_shared<PortalQuad>(
           portalSh, offB, normB, f.dims.x * 0.5f, f.dims.y * 0.5f);
 
-      cell->getGeometry().push_back(surfA);
-      cell->getGeometry().push_back(surfB);
+      cell->add(surfA);
+      dstCell->add(surfB);
 
       // link them with the same A2B transform
-      auto pA = std::make_shared<Portal>(surfA, cell, A2B);
+      auto pA = std::make_shared<Portal>(surfA, dstCell, A2B);
       auto pB = std::make_shared<Portal>(surfB, cell, glm::inverse(A2B));
       pA->setDestinationPortal(pB.get());
       pB->setDestinationPortal(pA.get());
       cell->addPortal(pA);
-      cell->addPortal(pB);
+      dstCell->addPortal(pB);
     }
   }
   static float randomXZ() {
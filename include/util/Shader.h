@@ -3,18 +3,58 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "util/GLState.h"
+
+/// GL type a uniform must have to be set from a T (see Shader::uniform)
+template <class T> struct UniformGLType;
+template <> struct UniformGLType<bool> {
+  static constexpr GLenum value = GL_BOOL;
+};
+template <> struct UniformGLType<GLint> {
+  static constexpr GLenum value = GL_INT; // also samplers
+};
+template <> struct UniformGLType<GLfloat> {
+  static constexpr GLenum value = GL_FLOAT;
+};
+template <> struct UniformGLType<glm::vec2> {
+  static constexpr GLenum value = GL_FLOAT_VEC2;
+};
+template <> struct UniformGLType<glm::vec3> {
+  static constexpr GLenum value = GL_FLOAT_VEC3;
+};
+template <> struct UniformGLType<glm::vec4> {
+  static constexpr GLenum value = GL_FLOAT_VEC4;
+};
+template <> struct UniformGLType<glm::mat3> {
+  static constexpr GLenum value = GL_FLOAT_MAT3;
+};
+template <> struct UniformGLType<glm::mat4> {
+  static constexpr GLenum value = GL_FLOAT_MAT4;
+};
+
+/// uniform traffic over one frame (see Shader::frameStats)
+struct UniformStats {
+  int lookups = 0;       // by name, through the hash table
+  int driverLookups = 0; // ... that had to call glGetUniformLocation
+  int uploads = 0;       // glUniform* calls
+};
+
 class Shader {
 public:
   static constexpr std::size_t kInfoLogBufferSize = 1024UL;
-  GLint clipLoc = -1;
+  // binding point of the "Camera" block (see render/CameraUniforms.h)
+  static constexpr GLuint kCameraBinding = 0;
 
 public:
   Shader() = delete;
@@ -67,7 +107,7 @@ public:
     glLinkProgram(shaderProgram);
     checkCompileErrors(shaderProgram, "PROGRAM");
 
-    clipLoc = glGetUniformLocation(shaderProgram, "uClipPlane");
+    reflect();
 
     // delete the Shader as they're linked into our program now and no longer
     // necessary
@@ -158,7 +198,7 @@ public:
     glLinkProgram(shaderProgram);
     checkCompileErrors(shaderProgram, "PROGRAM");
 
-    clipLoc = glGetUniformLocation(shaderProgram, "uClipPlane");
+    reflect();
 
     // delete the Shader as they're linked into our program now and no longer
     // necessary
@@ -168,6 +208,35 @@ public:
     glDeleteShader(fragShader);
   }
 
+  // a compute program (GL 4.3)
+  explicit Shader(const char *compShaderPath) {
+    std::string compShaderCode;
+
+    if (std::ifstream fin{compShaderPath, std::ifstream::in}) {
+      std::ostringstream sout;
+      sout << fin.rdbuf();
+      compShaderCode = sout.str();
+    } else {
+      throw std::runtime_error("compute shader file not successfully read");
+    }
+
+    const char *compShaderPtr = compShaderCode.data();
+
+    GLuint compShader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compShader, 1, &compShaderPtr, nullptr);
+    glCompileShader(compShader);
+    checkCompileErrors(compShader, "COMPUTE");
+
+    shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, compShader);
+    glLinkProgram(shaderProgram);
+    checkCompileErrors(shaderProgram, "PROGRAM");
+
+    reflect();
+
+    glDeleteShader(compShader);
+  }
+
   Shader(Shader &&rhs) noexcept { *this = std::move(rhs); }
 
   Shader &operator=(Shader &&rhs) noexcept {
@@ -177,73 +246,150 @@ public:
 
     shaderProgram = rhs.shaderProgram;
     rhs.shaderProgram = 0U;
+    uniforms = std::move(rhs.uniforms);
+    blocks = std::move(rhs.blocks);
 
     return *this;
   }
 
-  ~Shader() { glDeleteProgram(shaderProgram); }
+  ~Shader() { GLState::inst().deleteProgram(shaderProgram); }
 
-  void use() const { glUseProgram(shaderProgram); }
+  void use() const { GLState::inst().useProgram(shaderProgram); }
 
+  // name-based setters: a hashed lookup into the reflected uniforms
   void setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()),
-                static_cast<GLint>(value));
+    set(Uniform<bool>{location(name)}, value);
   }
 
   void setInt(const std::string &name, GLint value) const {
-    glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+    set(Uniform<GLint>{location(name)}, value);
   }
 
   void setFloat(const std::string &name, GLfloat value) const {
-    glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+    set(Uniform<GLfloat>{location(name)}, value);
   }
 
   void setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                 &value[0]);
+    set(Uniform<glm::vec2>{location(name)}, value);
   }
 
   void setVec2(const std::string &name, GLfloat x, GLfloat y) const {
-    glUniform2f(glGetUniformLocation(shaderProgram, name.c_str()), x, y);
+    set(Uniform<glm::vec2>{location(name)}, glm::vec2(x, y));
   }
 
   void setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                 &value[0]);
+    set(Uniform<glm::vec3>{location(name)}, value);
   }
 
   void setVec3(const std::string &name, GLfloat x, GLfloat y, GLfloat z) const {
-    glUniform3f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z);
+    set(Uniform<glm::vec3>{location(name)}, glm::vec3(x, y, z));
   }
 
   void setVec4(const std::string &name, const glm::vec4 &value) const {
-    glUniform4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                 &value[0]);
+    set(Uniform<glm::vec4>{location(name)}, value);
   }
 
   void setVec4(const std::string &name, GLfloat x, GLfloat y, GLfloat z,
                GLfloat w) const {
-    glUniform4f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z, w);
+    set(Uniform<glm::vec4>{location(name)}, glm::vec4(x, y, z, w));
   }
 
   void setMat2(const std::string &name, const glm::mat2 &mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                       GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    countUpload();
   }
 
   void setMat2x3(const std::string &name, const glm::mat2x3 &mat) const {
-    glUniformMatrix2x3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                         GL_FALSE, &mat[0][0]);
+    glUniformMatrix2x3fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    countUpload();
   }
 
   void setMat3(const std::string &name, const glm::mat3 &mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                       GL_FALSE, &mat[0][0]);
+    set(Uniform<glm::mat3>{location(name)}, mat);
   }
 
   void setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1,
-                       GL_FALSE, &mat[0][0]);
+    set(Uniform<glm::mat4>{location(name)}, mat);
+  }
+
+  // typed handles: resolve once (e.g. in a shape's constructor), then set
+  // without any lookup. Names that aren't active uniforms give a handle that
+  // is silently ignored, like glUniform* with location -1.
+  template <class T> struct Uniform {
+    GLint location = -1;
+  };
+
+  template <class T> Uniform<T> uniform(const std::string &name) const {
+    auto it = uniforms.find(name);
+    if (it == uniforms.end() || it->second.location < 0)
+      return {};
+    if (!typeMatches(it->second.type, UniformGLType<T>::value))
+      throw std::runtime_error("uniform '" + name +
+                               "' set with the wrong type");
+    return {it->second.location};
+  }
+
+  void set(Uniform<bool> u, bool v) const {
+    glUniform1i(u.location, static_cast<GLint>(v));
+    countUpload();
+  }
+  void set(Uniform<GLint> u, GLint v) const {
+    glUniform1i(u.location, v);
+    countUpload();
+  }
+  void set(Uniform<GLfloat> u, GLfloat v) const {
+    glUniform1f(u.location, v);
+    countUpload();
+  }
+  void set(Uniform<glm::vec2> u, const glm::vec2 &v) const {
+    glUniform2fv(u.location, 1, &v[0]);
+    countUpload();
+  }
+  void set(Uniform<glm::vec3> u, const glm::vec3 &v) const {
+    glUniform3fv(u.location, 1, &v[0]);
+    countUpload();
+  }
+  void set(Uniform<glm::vec4> u, const glm::vec4 &v) const {
+    glUniform4fv(u.location, 1, &v[0]);
+    countUpload();
+  }
+  void set(Uniform<glm::mat3> u, const glm::mat3 &m) const {
+    glUniformMatrix3fv(u.location, 1, GL_FALSE, &m[0][0]);
+    countUpload();
+  }
+  void set(Uniform<glm::mat4> u, const glm::mat4 &m) const {
+    glUniformMatrix4fv(u.location, 1, GL_FALSE, &m[0][0]);
+    countUpload();
+  }
+
+  // location of a uniform by name (-1 if the program doesn't use it)
+  GLint location(const std::string &name) const {
+    countLookup();
+    auto it = uniforms.find(name);
+    if (it != uniforms.end())
+      return it->second.location;
+
+    // not reflected (e.g. "lights[3]"): ask GL once and remember the answer
+    countDriverLookup();
+    GLint loc = glGetUniformLocation(shaderProgram, name.c_str());
+    uniforms.emplace(name, UniformInfo{loc, GL_NONE, 0});
+    return loc;
+  }
+
+  // index of a uniform block, or GL_INVALID_INDEX
+  GLuint blockIndex(const std::string &name) const {
+    auto it = blocks.find(name);
+    return it != blocks.end() ? it->second : GL_INVALID_INDEX;
+  }
+
+  GLuint program() const { return shaderProgram; }
+
+  // uniform traffic of the last complete frame, over all shaders. Counted in
+  // debug builds only (all zero in release).
+  static const UniformStats &frameStats() { return s_lastFrame; }
+  static void beginFrame() {
+    s_lastFrame = s_frame;
+    s_frame = {};
   }
 
 private:
@@ -277,8 +423,101 @@ private:
     }
   }
 
+  // every active uniform outside a block, and every block, by name; arrays
+  // are reachable both as "a[0]" and "a"
+  void reflect() {
+    GLint count = 0, maxLen = 0;
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+    std::string buf(std::max(maxLen, 1), '\0');
+    for (GLint i = 0; i < count; ++i) {
+      GLsizei len = 0;
+      GLint size = 0;
+      GLenum type = GL_NONE;
+      glGetActiveUniform(shaderProgram, GLuint(i), GLsizei(buf.size()), &len,
+                         &size, &type, buf.data());
+      std::string name(buf.data(), len);
+
+      GLint loc = glGetUniformLocation(shaderProgram, name.c_str());
+      if (loc < 0)
+        continue; // member of a uniform block
+
+      uniforms[name] = {loc, type, size};
+      if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        uniforms[name.substr(0, name.size() - 3)] = {loc, type, size};
+    }
+
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,
+                   &maxLen);
+    buf.assign(std::max(maxLen, 1), '\0');
+    for (GLint i = 0; i < count; ++i) {
+      GLsizei len = 0;
+      glGetActiveUniformBlockName(shaderProgram, GLuint(i),
+                                  GLsizei(buf.size()), &len, buf.data());
+      blocks[std::string(buf.data(), len)] = GLuint(i);
+    }
+
+    // GLSL 3.30 has no layout(binding = N): attach the shared blocks here
+    GLuint camera = blockIndex("Camera");
+    if (camera != GL_INVALID_INDEX)
+      glUniformBlockBinding(shaderProgram, camera, kCameraBinding);
+  }
+
+  static bool typeMatches(GLenum have, GLenum want) {
+    if (have == want)
+      return true;
+    switch (want) {
+    case GL_BOOL:
+      return have == GL_INT;
+    case GL_INT: // ints, bools and samplers are all set with glUniform1i
+      switch (have) {
+      case GL_BOOL:
+      case GL_SAMPLER_1D:
+      case GL_SAMPLER_2D:
+      case GL_SAMPLER_3D:
+      case GL_SAMPLER_CUBE:
+      case GL_SAMPLER_2D_SHADOW:
+      case GL_SAMPLER_2D_ARRAY:
+      case GL_SAMPLER_2D_MULTISAMPLE:
+      case GL_SAMPLER_BUFFER:
+        return true;
+      default:
+        return false;
+      }
+    default:
+      return false;
+    }
+  }
+
+  static void countLookup() {
+#ifndef NDEBUG
+    ++s_frame.lookups;
+#endif
+  }
+  static void countDriverLookup() {
+#ifndef NDEBUG
+    ++s_frame.driverLookups;
+#endif
+  }
+  static void countUpload() {
+#ifndef NDEBUG
+    ++s_frame.uploads;
+#endif
+  }
+
 private:
   GLuint shaderProgram{0U};
+
+  struct UniformInfo {
+    GLint location;
+    GLenum type; // GL_NONE for names found after reflection
+    GLint size;  // array length
+  };
+  mutable std::unordered_map<std::string, UniformInfo> uniforms;
+  std::unordered_map<std::string, GLuint> blocks;
+
+  inline static UniformStats s_frame, s_lastFrame;
 };
 
 #endif // SHADER_H
@@ -26,6 +26,20 @@ public:
     return texturedShader.get();
   }
 
+  Shader *instanced() {
+    if (!instancedShader)
+      instancedShader = std::make_unique<Shader>(
+          "src/shader/instanced.vert.glsl", "src/shader/instanced.frag.glsl");
+    return instancedShader.get();
+  }
+
+  Shader *skybox() {
+    if (!skyboxShader)
+      skyboxShader = std::make_unique<Shader>("src/shader/skybox.vert.glsl",
+                                              "src/shader/skybox.frag.glsl");
+    return skyboxShader.get();
+  }
+
   Shader *flatWhite() {
     if (!flatShader)
       flatShader = std::make_unique<Shader>("src/shader/flat.vert.glsl",
@@ -41,11 +55,46 @@ public:
     return portal_quadShader.get();
   }
 
+  /// the StaticBatch variant of <s>: same fragment shader, model matrix from
+  /// the "Draws" storage buffer (GL 4.3). nullptr if <s> has none.
+  Shader *indirect(const Shader *s) {
+    if (!s)
+      return nullptr;
+    if (s == phongShader.get()) {
+      if (!phongIndirectShader)
+        phongIndirectShader = std::make_unique<Shader>(
+            "src/shader/phong_indirect.vert.glsl",
+            "src/shader/phong.frag.glsl");
+      return phongIndirectShader.get();
+    }
+    if (s == texturedShader.get()) {
+      // tex0 keeps its default, unit 0
+      if (!texturedIndirectShader)
+        texturedIndirectShader = std::make_unique<Shader>(
+            "src/shader/textured_indirect.vert.glsl",
+            "src/shader/textured.frag.glsl");
+      return texturedIndirectShader.get();
+    }
+    return nullptr;
+  }
+
+  /// StaticBatch's per-view culling pass (compute, GL 4.3)
+  Shader *cull() {
+    if (!cullShader)
+      cullShader = std::make_unique<Shader>("src/shader/cull.comp.glsl");
+    return cullShader.get();
+  }
+
 private:
   ShaderStore() = default;
   std::unique_ptr<Shader> phongShader;
   std::unique_ptr<Shader> texturedShader;
+  std::unique_ptr<Shader> instancedShader;
+  std::unique_ptr<Shader> skyboxShader;
   std::unique_ptr<Shader> flatShader;
   std::unique_ptr<Shader> portal_quadShader;
+  std::unique_ptr<Shader> phongIndirectShader;
+  std::unique_ptr<Shader> texturedIndirectShader;
+  std::unique_ptr<Shader> cullShader;
 };
 #endif
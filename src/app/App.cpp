@@ -4,7 +4,10 @@
 #include "app/DebugUI.h"
 #include "render/PortalRenderer.h"
 #include "render/Renderer.h"
+#include "shape/TextureStreamer.h"
+#include "util/GLState.h"
 #include "util/SceneManager.h"
+#include "util/Shader.h"
 
 #include <glad/glad.h>
 
@@ -53,6 +56,9 @@ void App::run() {
     double now = glfwGetTime();
     float dt = static_cast<float>(now - last);
     last = now;
+    Shader::beginFrame();
+    GLState::inst().beginFrame();
+    TextureStreamer::inst().pump();
 
     Scene &scene = sceneMgr->currentSceneMutable();
     controls->update(dt);
@@ -84,6 +90,6 @@ void App::renderFrame(float /*dt*/) {
 }
 
 void App::framebufferSizeCallback(GLFWwindow *, int w, int h) {
-  glViewport(0, 0, w, h);
+  GLState::inst().viewport(0, 0, w, h);
   instance().renderer->resize(w, h);
 }
@@ -1,8 +1,14 @@
 #include "app/DebugUI.h"
 #include "app/Controls.h"
+#include "render/GeometryArena.h"
+#include "render/StaticBatch.h"
 #include "render/Renderer.h"
 #include "shape/Texture.h"
+#include "shape/TextureStreamer.h"
+#include "util/GLState.h"
+#include "util/ResourceCache.h"
 #include "util/SceneManager.h"
+#include "util/Shader.h"
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 #include <imgui.h>
@@ -17,7 +23,7 @@ static void DrawSettings(Renderer &renderer, Controls &c) {
     static bool vsync = true;
 
     if (ImGui::Checkbox("MSAA", &msaa))
-      msaa ? glEnable(GL_MULTISAMPLE) : glDisable(GL_MULTISAMPLE);
+      GLState::inst().set(GL_MULTISAMPLE, msaa);
 
     float aniso = Texture2D::anisotropy(); // current
     float maxAniso = Texture2D::maxAnisotropy();
@@ -31,6 +37,114 @@ static void DrawSettings(Renderer &renderer, Controls &c) {
       glfwSwapInterval(vsync ? 1 : 0);
 
     ImGui::SliderInt("Recursion depth", &renderer.recursionDepth, 0, 10);
+
+    ImGui::Text("Portals:");
+    ImGui::SameLine();
+    if (ImGui::RadioButton("FBO", renderer.portalMode == PortalMode::Texture))
+      renderer.portalMode = PortalMode::Texture;
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Stencil",
+                           renderer.portalMode == PortalMode::Stencil))
+      renderer.portalMode = PortalMode::Stencil;
+
+    ImGui::Checkbox("Adaptive portal resolution",
+                    &renderer.portalOptions.adaptiveResolution);
+    if (renderer.portalOptions.adaptiveResolution)
+      ImGui::Checkbox("Share equivalent portal views",
+                      &renderer.portalOptions.memoizeViews);
+    ImGui::Checkbox("Frustum culling", &renderer.portalOptions.frustumCulling);
+    ImGui::Checkbox("Model level of detail", &renderer.portalOptions.meshLod);
+    if (StaticBatch::supported()) {
+      ImGui::Checkbox("Multi-draw-indirect static geometry",
+                      &renderer.portalOptions.indirectDraw);
+      if (renderer.portalOptions.indirectDraw &&
+          renderer.portalOptions.frustumCulling) {
+        if (StaticBatch::cullingSupported())
+          ImGui::Checkbox("  cull it on the GPU",
+                          &renderer.portalOptions.gpuCulling);
+        else
+          ImGui::TextDisabled("  GPU culling: needs compute shaders");
+      }
+    } else
+      ImGui::TextDisabled("Multi-draw-indirect: needs GL 4.3");
+    ImGui::Checkbox("Portal occlusion queries",
+                    &renderer.portalOptions.occlusionQueries);
+    ImGui::Checkbox("Portal frame budget",
+                    &renderer.portalOptions.frameBudget);
+    if (renderer.portalOptions.frameBudget)
+      ImGui::SliderFloat("Budget (ms)", &renderer.portalOptions.frameBudgetMs,
+                         0.5f, 33.f, "%.1f");
+    ImGui::Checkbox("Temporal portal reuse",
+                    &renderer.portalOptions.temporalReuse);
+    if (renderer.portalOptions.temporalReuse) {
+      ImGui::SliderInt("Max staleness (frames)",
+                       &renderer.portalOptions.maxStaleFrames, 1, 30);
+      ImGui::SliderFloat("Reuse max move", &renderer.portalOptions.reuseMaxMove,
+                         0.0f, 0.2f, "%.3f");
+      ImGui::SliderFloat("Reuse max turn (deg)",
+                         &renderer.portalOptions.reuseMaxAngle, 0.0f, 5.0f,
+                         "%.2f");
+    }
+
+    const PortalStats &ps = renderer.portals().stats();
+    ImGui::Text("View nodes: %d  shared: %d", ps.viewNodes, ps.viewsShared);
+    ImGui::Text("Portals drawn: %d  culled: %d  occluded: %d", ps.portalsDrawn,
+                ps.portalsCulled, ps.portalsOccluded);
+    ImGui::Text("Portals reused: %d  deferred: %d", ps.portalsReused,
+                ps.portalsDeferred);
+    ImGui::Text("Portal GPU time (estimated): %.2f ms", ps.portalPlannedMs);
+    ImGui::Text("Render targets: %d peak / %d allocated", ps.targetsPeak,
+                ps.targetsAllocated);
+    if (ps.portalTexelsFull > 0.0)
+      ImGui::Text("Portal fill: %.0f%% of full-res",
+                  100.0 * ps.portalTexels / ps.portalTexelsFull);
+    ImGui::Text("Objects drawn: %d  culled: %d", ps.objectsDrawn,
+                ps.objectsCulled);
+    ImGui::Text("State changes: %d unsorted -> %d sorted (%d draws)",
+                ps.draws.naiveChanges, ps.draws.changes(), ps.draws.packets);
+    ImGui::Text("  programs %d  textures %d  VAOs %d", ps.draws.programs,
+                ps.draws.textures, ps.draws.vaos);
+    if (ps.draws.multiDraws)
+      ImGui::Text("  static: %d draws in %d indirect calls (%d GPU-culled)",
+                  ps.draws.batchedDraws, ps.draws.multiDraws,
+                  ps.draws.gpuCulled);
+    ImGui::Text("Model triangles: %lld", ps.draws.triangles);
+    const MeshLoadStats &ml = ResourceCache::inst().meshStats();
+    ImGui::Text("Models: %d loaded (%d cooked) in %.1f ms", ml.assets,
+                ml.cooked, ml.ms);
+    const GeometryArenaStats ga = GeometryArena::inst().stats();
+    ImGui::Text("Geometry: %.1f / %.1f MB in %d pages, %d blocks, "
+                "%.0f%% fragmented",
+                ga.bytes / (1024.0 * 1024.0), ga.capacity / (1024.0 * 1024.0),
+                ga.pages, ga.blocks, ga.fragmentation * 100.f);
+    const TextureMemoryStats tm = ResourceCache::inst().textureMemory();
+    ImGui::Text("Texture memory: %.1f MB, %d/%d compressed (%.1f MB saved)",
+                tm.bytes / (1024.0 * 1024.0), tm.compressed, tm.textures,
+                (tm.rgbaBytes - tm.bytes) / (1024.0 * 1024.0));
+    const TextureStreamStats &ts = TextureStreamer::inst().frameStats();
+    ImGui::Text("Textures: %d streaming, %d uploaded (%.1f MB)", ts.pending,
+                ts.uploaded, ts.bytes / (1024.0 * 1024.0));
+    const GLStateStats &gs = GLState::inst().frameStats();
+    ImGui::Text("GL state calls: %d issued, %d skipped", gs.issued,
+                gs.skipped);
+#ifndef NDEBUG
+    const UniformStats &us = Shader::frameStats();
+    ImGui::Text("Uniforms: %d uploads, %d lookups (%d by GL)", us.uploads,
+                us.lookups, us.driverLookups);
+#endif
+    if (ImGui::TreeNode("Per-view culling")) {
+      for (const PortalViewStats &v : ps.perView)
+        ImGui::Text("%*slevel %d: %d drawn, %d culled, %lld triangles",
+                    2 * v.level, "", v.level, v.drawn, v.culled, v.triangles);
+      ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Model memory")) {
+      for (const MeshMemoryStats &m : ResourceCache::inst().meshMemory())
+        ImGui::Text("%s%s: %.1f KB CPU, %.1f KB GPU", m.path.c_str(),
+                    m.cpuCopy ? " (CPU copy)" : "", m.cpuBytes / 1024.0,
+                    m.gpuBytes / 1024.0);
+      ImGui::TreePop();
+    }
   }
 
   // --------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #include <glad/glad.h>
 
 #include "app/Window.h"
+#include "util/GLState.h"
 #include <GLFW/glfw3.h>
 #include <stdexcept>
 
@@ -14,6 +15,7 @@ Window::Window(int width, int height, const char *title) {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   glfwWindowHint(GLFW_DEPTH_BITS, 24);
+  glfwWindowHint(GLFW_STENCIL_BITS, 8); // stencil portal recursion
   // Create the window
   pWindow = glfwCreateWindow(width, height, title, nullptr, nullptr);
   if (!pWindow) {
@@ -30,15 +32,16 @@ Window::Window(int width, int height, const char *title) {
     glfwTerminate();
     throw std::runtime_error("Failed to initialize GLAD");
   }
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+  GLState::inst().enable(GL_DEPTH_TEST);
+  GLState::inst().depthFunc(GL_LESS);
+  GLState::inst().enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
   /*glEnable(GL_CULL_FACE);*/
   /*glCullFace(GL_BACK);*/
   glFrontFace(GL_CCW);
 
   // By default, set the initial viewport
-  glViewport(0, 0, width, height);
+  GLState::inst().viewport(0, 0, width, height);
 }
 
 Window::~Window() noexcept {
@@ -1,5 +1,17 @@
 #include "render/AdaptiveFramebuffer.h"
 #include "render/FramebufferUtils.h"
+#include "util/GLState.h"
+#include <algorithm>
+#include <cmath>
+
+AdaptiveFramebuffer::~AdaptiveFramebuffer() {
+  if (fbo)
+    GLState::inst().deleteFramebuffers(1, &fbo);
+  if (color)
+    GLState::inst().deleteTextures(1, &color);
+  if (depth)
+    GLState::inst().deleteTextures(1, &depth);
+}
 
 void AdaptiveFramebuffer::allocate(int W, int H) {
   w = W;
@@ -7,13 +19,13 @@ void AdaptiveFramebuffer::allocate(int W, int H) {
 
   if (!fbo)
     glGenFramebuffers(1, &fbo);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
   // (re)create textures
   if (color)
-    glDeleteTextures(1, &color);
+    GLState::inst().deleteTextures(1, &color);
   if (depth)
-    glDeleteTextures(1, &depth);
+    GLState::inst().deleteTextures(1, &depth);
 
   color = fb::makeColorTex(w, h);
   depth = fb::makeDepthTex(w, h);
@@ -23,12 +35,43 @@ void AdaptiveFramebuffer::allocate(int W, int H) {
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
                          depth, 0);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void AdaptiveFramebuffer::bind() {
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, fbo);
+}
+void AdaptiveFramebuffer::unbind() {
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void AdaptiveFramebuffer::bind() { glBindFramebuffer(GL_FRAMEBUFFER, fbo); }
-void AdaptiveFramebuffer::unbind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+void AdaptiveFramebuffer::setBaseSize(int W, int H) {
+  baseW = W;
+  baseH = H;
+}
 
 void AdaptiveFramebuffer::setTargetFraction(float frac) {
-  targetFraction = frac;
+  targetFraction = std::clamp(frac, kMinFraction, 1.f);
+
+  // per-axis scale, rounded up to kAlign and capped at the base size
+  auto fit = [](int base, float s) {
+    int v = int(std::ceil(base * s));
+    v = (v + kAlign - 1) / kAlign * kAlign;
+    return std::clamp(v, 1, base);
+  };
+  float s = std::sqrt(targetFraction);
+  int wantW = fit(baseW, s), wantH = fit(baseH, s);
+
+  if (!fbo || wantW > w || wantH > h) {
+    // grow with some headroom so a slowly growing portal settles quickly
+    allocate(fit(baseW, s * kGrowHeadroom), fit(baseH, s * kGrowHeadroom));
+    shrinkFrames = 0;
+  } else if (float(wantW) * wantH < kShrinkBelow * float(w) * h) {
+    if (++shrinkFrames >= kShrinkDelay) {
+      allocate(wantW, wantH);
+      shrinkFrames = 0;
+    }
+  } else {
+    shrinkFrames = 0;
+  }
 }
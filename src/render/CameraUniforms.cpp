@@ -0,0 +1,65 @@
+#include "render/CameraUniforms.h"
+#include "util/Shader.h"
+#include <algorithm>
+#include <cstring>
+
+CameraUniforms::~CameraUniforms() {
+  if (ubo)
+    glDeleteBuffers(1, &ubo);
+}
+
+void CameraUniforms::beginFrame() {
+  blocks.clear();
+  cur = -1;
+  if (ubo) {
+    // fresh storage, so this frame's writes don't wait on last frame's draws
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, capacity * stride, nullptr,
+                 GL_STREAM_DRAW);
+  }
+}
+
+void CameraUniforms::reserve(int slots) {
+  if (!ubo) {
+    glGenBuffers(1, &ubo);
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    stride = (GLsizeiptr(sizeof(Block)) + align - 1) / align * align;
+  }
+  if (slots <= capacity)
+    return;
+
+  capacity = std::max(slots, std::max(16, capacity * 2));
+
+  // re-specifying the store leaves draws already issued on the old one; the
+  // slots written so far this frame are copied over
+  std::vector<char> staging(capacity * stride);
+  for (std::size_t i = 0; i < blocks.size(); ++i)
+    std::memcpy(staging.data() + i * stride, &blocks[i], sizeof(Block));
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferData(GL_UNIFORM_BUFFER, capacity * stride, staging.data(),
+               GL_STREAM_DRAW);
+}
+
+int CameraUniforms::push(const glm::mat4 &V, const glm::mat4 &P,
+                         const glm::vec3 &eye, const glm::vec4 &clipPlane) {
+  blocks.push_back({V, P, P * V, glm::vec4(eye, 1.f), clipPlane});
+  int slot = int(blocks.size()) - 1;
+
+  if (slot >= capacity) {
+    reserve(slot + 1); // uploads this slot with the rest
+  } else {
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, slot * stride, sizeof(Block),
+                    &blocks.back());
+  }
+
+  bind(slot);
+  return slot;
+}
+
+void CameraUniforms::bind(int slot) {
+  glBindBufferRange(GL_UNIFORM_BUFFER, Shader::kCameraBinding, ubo,
+                    slot * stride, sizeof(Block));
+  cur = slot;
+}
@@ -0,0 +1,91 @@
+#include "render/DrawList.h"
+#include "shape/Renderable.h"
+#include "util/GLState.h"
+#include "util/Shader.h"
+#include <algorithm>
+#include <limits>
+
+void DrawList::begin(const glm::vec3 &e, float far) {
+  packets.clear();
+  eye = e;
+  farPlane = far;
+  detailScale = 0.f;
+}
+
+float DrawList::screenSize(const Bounds &b) const {
+  if (detailScale <= 0.f || b.empty())
+    return std::numeric_limits<float>::infinity();
+  const float r = b.radius();
+  const float d = glm::length(b.center() - eye);
+  if (d <= r) // the camera is inside it
+    return std::numeric_limits<float>::infinity();
+  return 2.f * r * detailScale / d;
+}
+
+std::uint32_t DrawList::depthBits(const Bounds &b) const {
+  if (b.empty())
+    return 0xFFFFFFu; // unknown: last within its state
+  float d = glm::length(b.center() - eye) / farPlane;
+  return std::uint32_t(glm::clamp(d, 0.f, 1.f) * float(0xFFFFFF));
+}
+
+void DrawList::add(const Shader *shader, GLenum textureTarget, GLuint texture,
+                   GLuint vao, Renderable *object, int part,
+                   const Bounds &bounds, int triangles) {
+  std::uint64_t key = std::uint64_t(shader->program() & 0xFF) << 56 |
+                      std::uint64_t(texture & 0xFFFF) << 40 |
+                      std::uint64_t(vao & 0xFFFF) << 24 | depthBits(bounds);
+  packets.push_back(
+      {key, shader, textureTarget, texture, vao, object, part, triangles});
+}
+
+void DrawList::addOpaque(Renderable *object, const Bounds &bounds) {
+  // after everything else (key 0xFF...), so it can't split a batch
+  std::uint64_t key = ~std::uint64_t(0) << 24 | depthBits(bounds);
+  packets.push_back({key, nullptr, GL_TEXTURE_2D, 0, 0, object, 0, 0});
+}
+
+void DrawList::submit(DrawListStats &stats) {
+  for (const Packet &p : packets) {
+    if (p.shader)
+      stats.naiveChanges += 2 + (p.texture != 0);
+    stats.triangles += p.triangles;
+  }
+  stats.packets += int(packets.size());
+
+  std::sort(packets.begin(), packets.end(),
+            [](const Packet &a, const Packet &b) { return a.key < b.key; });
+
+  const Shader *curShader = nullptr;
+  GLuint curTexture = 0, curVao = 0;
+  bool known = false; // false after an opaque draw: bindings are unknown
+  GLState::inst().activeTexture(GL_TEXTURE0);
+
+  for (const Packet &p : packets) {
+    if (!p.shader) {
+      p.object->render();
+      known = false;
+      continue;
+    }
+
+    if (!known || p.shader != curShader) {
+      p.shader->use();
+      curShader = p.shader;
+      ++stats.programs;
+    }
+    if (p.texture && (!known || p.texture != curTexture)) {
+      GLState::inst().activeTexture(GL_TEXTURE0);
+      GLState::inst().bindTexture(p.textureTarget, p.texture);
+      curTexture = p.texture;
+      ++stats.textures;
+    }
+    if (!known || p.vao != curVao) {
+      GLState::inst().bindVertexArray(p.vao);
+      curVao = p.vao;
+      ++stats.vaos;
+    }
+    known = true;
+
+    p.object->drawPart(p.part);
+  }
+}
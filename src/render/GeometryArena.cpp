@@ -0,0 +1,250 @@
+#include "render/GeometryArena.h"
+#include "util/GLState.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// default page: 8 MB of vertices and 1M indices (4 MB)
+constexpr std::size_t kPageVertexBytes = 8u << 20;
+constexpr std::size_t kPageIndices = 1u << 20;
+
+} // namespace
+
+/* -------- RangeAllocator -------- */
+
+RangeAllocator::RangeAllocator(std::size_t capacity) : cap(capacity) {
+  if (cap)
+    holes.emplace(0, cap);
+}
+
+std::size_t RangeAllocator::allocate(std::size_t n) {
+  if (n == 0)
+    return 0;
+  for (auto it = holes.begin(); it != holes.end(); ++it) {
+    if (it->second < n)
+      continue;
+    const std::size_t offset = it->first, left = it->second - n;
+    holes.erase(it);
+    if (left)
+      holes.emplace(offset + n, left);
+    inUse += n;
+    return offset;
+  }
+  return kNone;
+}
+
+void RangeAllocator::release(std::size_t offset, std::size_t n) {
+  if (n == 0)
+    return;
+  inUse -= n;
+  auto next = holes.lower_bound(offset);
+  // swallow the hole right after, then let the one before swallow us
+  if (next != holes.end() && next->first == offset + n) {
+    n += next->second;
+    next = holes.erase(next);
+  }
+  if (next != holes.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += n;
+      return;
+    }
+  }
+  holes.emplace_hint(next, offset, n);
+}
+
+std::size_t RangeAllocator::largestFree() const {
+  std::size_t best = 0;
+  for (const auto &[offset, size] : holes)
+    best = std::max(best, size);
+  return best;
+}
+
+/* -------- pages -------- */
+
+struct GeometryArena::Page {
+  Page(VertexFormat f, std::size_t vertexCapacity, std::size_t indexCapacity)
+      : format(f), vertexSpace(vertexCapacity), indexSpace(indexCapacity) {}
+  ~Page() {
+    GLState::inst().deleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+  }
+
+  VertexFormat format;
+  RangeAllocator vertexSpace, indexSpace;
+  GLuint vao = 0, vbo = 0, ebo = 0;
+  int blocks = 0;
+};
+
+std::size_t GeometryArena::stride(VertexFormat format) {
+  switch (format) {
+  case VertexFormat::P3:
+    return 3 * sizeof(float);
+  case VertexFormat::P3T2:
+    return 5 * sizeof(float);
+  case VertexFormat::P3N3T2:
+  default:
+    return 8 * sizeof(float);
+  }
+}
+
+GeometryArena::~GeometryArena() { glDeleteBuffers(1, &drawIndices); }
+
+std::shared_ptr<GeometryArena::Page>
+GeometryArena::newPage(VertexFormat format, std::size_t vertices,
+                       std::size_t indices) {
+  const std::size_t stride = GeometryArena::stride(format);
+  auto page = std::make_shared<Page>(
+      format, std::max(vertices, kPageVertexBytes / stride),
+      std::max(indices, kPageIndices));
+
+  glGenVertexArrays(1, &page->vao);
+  glGenBuffers(1, &page->vbo);
+  glGenBuffers(1, &page->ebo);
+
+  GLState::inst().bindVertexArray(page->vao);
+  glBindBuffer(GL_ARRAY_BUFFER, page->vbo);
+  glBufferData(GL_ARRAY_BUFFER,
+               GLsizeiptr(page->vertexSpace.capacity() * stride), nullptr,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page->ebo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               GLsizeiptr(page->indexSpace.capacity() * sizeof(unsigned)),
+               nullptr, GL_STATIC_DRAW);
+
+  // every layout starts with the position; P3N3T2 is Vertex
+  const GLsizei s = GLsizei(stride);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, s, (void *)0);
+  glEnableVertexAttribArray(0);
+  if (format == VertexFormat::P3T2) {
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, s,
+                          (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+  } else if (format == VertexFormat::P3N3T2) {
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, s,
+                          (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, s,
+                          (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+  }
+
+  if (!drawIndices) {
+    std::vector<GLuint> ids(kMaxDrawIndex);
+    for (GLuint i = 0; i < kMaxDrawIndex; ++i)
+      ids[i] = i;
+    glGenBuffers(1, &drawIndices);
+    glBindBuffer(GL_ARRAY_BUFFER, drawIndices);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(ids.size() * sizeof(GLuint)),
+                 ids.data(), GL_STATIC_DRAW);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, drawIndices);
+  glVertexAttribIPointer(kDrawIndexAttrib, 1, GL_UNSIGNED_INT, 0, (void *)0);
+  glEnableVertexAttribArray(kDrawIndexAttrib);
+  glVertexAttribDivisor(kDrawIndexAttrib, 1);
+  GLState::inst().bindVertexArray(0);
+
+  pages.push_back(page);
+  return page;
+}
+
+GeometryBlock GeometryArena::allocate(VertexFormat format,
+                                      const void *vertices,
+                                      std::size_t vertexCount,
+                                      const unsigned *indices,
+                                      std::size_t indexCount) {
+  GeometryBlock b;
+  b.fmt = format;
+  b.vertices = vertexCount;
+  b.indices = indexCount;
+
+  for (const auto &p : pages) {
+    if (p->format != format)
+      continue;
+    const std::size_t v = p->vertexSpace.allocate(vertexCount);
+    if (v == RangeAllocator::kNone)
+      continue;
+    const std::size_t i = p->indexSpace.allocate(indexCount);
+    if (i == RangeAllocator::kNone) {
+      p->vertexSpace.release(v, vertexCount);
+      continue;
+    }
+    b.page = p;
+    b.vertexOffset = v;
+    b.indexOffset = i;
+    break;
+  }
+  if (!b.page) {
+    b.page = newPage(format, vertexCount, indexCount);
+    b.vertexOffset = b.page->vertexSpace.allocate(vertexCount);
+    b.indexOffset = b.page->indexSpace.allocate(indexCount);
+  }
+  ++b.page->blocks;
+
+  // GL_COPY_WRITE_BUFFER: filling the index buffer this way needs no VAO
+  const std::size_t s = stride(format);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, b.page->vbo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(b.vertexOffset * s),
+                  GLsizeiptr(vertexCount * s), vertices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, b.page->ebo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER,
+                  GLintptr(b.indexOffset * sizeof(unsigned)),
+                  GLsizeiptr(indexCount * sizeof(unsigned)), indices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  return b;
+}
+
+GeometryArenaStats GeometryArena::stats() const {
+  GeometryArenaStats s;
+  std::size_t free = 0, largest = 0;
+  for (const auto &p : pages) {
+    const std::size_t vs = stride(p->format), is = sizeof(unsigned);
+    const RangeAllocator &v = p->vertexSpace, &i = p->indexSpace;
+    ++s.pages;
+    s.blocks += p->blocks;
+    s.bytes += v.used() * vs + i.used() * is;
+    s.capacity += v.capacity() * vs + i.capacity() * is;
+    free += (v.capacity() - v.used()) * vs + (i.capacity() - i.used()) * is;
+    largest += v.largestFree() * vs + i.largestFree() * is;
+  }
+  if (free)
+    s.fragmentation = 1.f - float(largest) / float(free);
+  return s;
+}
+
+/* -------- GeometryBlock -------- */
+
+GeometryBlock &GeometryBlock::operator=(GeometryBlock &&rhs) noexcept {
+  if (this != &rhs) {
+    release();
+    page = std::move(rhs.page);
+    fmt = rhs.fmt;
+    vertexOffset = rhs.vertexOffset;
+    vertices = rhs.vertices;
+    indexOffset = rhs.indexOffset;
+    indices = rhs.indices;
+  }
+  return *this;
+}
+
+GeometryBlock::~GeometryBlock() { release(); }
+
+void GeometryBlock::release() {
+  if (!page)
+    return;
+  page->vertexSpace.release(vertexOffset, vertices);
+  page->indexSpace.release(indexOffset, indices);
+  --page->blocks;
+  page.reset();
+}
+
+GLuint GeometryBlock::vertexArray() const { return page ? page->vao : 0; }
+
+void GeometryBlock::draw(GLsizei count, GLsizei first) const {
+  glDrawElementsBaseVertex(
+      GL_TRIANGLES, count, GL_UNSIGNED_INT,
+      (void *)((indexOffset + std::size_t(first)) * sizeof(unsigned)),
+      GLint(vertexOffset));
+}
@@ -0,0 +1,88 @@
+#include "render/OcclusionQueries.h"
+
+OcclusionQueries::~OcclusionQueries() { clear(); }
+
+// the conservative variant is cheaper where available (GL 4.3 / ES3 compat)
+GLenum OcclusionQueries::target() const {
+  return GLAD_GL_ARB_ES3_compatibility ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+                                       : GL_ANY_SAMPLES_PASSED;
+}
+
+void OcclusionQueries::clear() {
+  for (auto &kv : nodes)
+    for (auto &s : kv.second.ring)
+      if (s.id)
+        glDeleteQueries(1, &s.id);
+  nodes.clear();
+}
+
+void OcclusionQueries::beginFrame(int frameNo) {
+  frame = frameNo;
+
+  for (auto it = nodes.begin(); it != nodes.end();) {
+    Node &n = it->second;
+
+    for (auto &s : n.ring) {
+      if (!s.pending)
+        continue;
+      GLint ready = 0;
+      glGetQueryObjectiv(s.id, GL_QUERY_RESULT_AVAILABLE, &ready);
+      if (!ready)
+        continue;
+
+      GLuint any = 0;
+      glGetQueryObjectuiv(s.id, GL_QUERY_RESULT, &any);
+      s.pending = false;
+
+      // several queries can share a frame (same portal reached through
+      // different chains): visible if any of them saw a sample
+      if (s.frame > n.resultFrame) {
+        n.resultFrame = s.frame;
+        n.visible = any != 0;
+      } else if (s.frame == n.resultFrame) {
+        n.visible = n.visible || any != 0;
+      }
+    }
+
+    bool busy = false;
+    for (auto &s : n.ring)
+      busy = busy || s.pending;
+
+    if (!busy && frame - n.lastIssued > kEvictFrames) {
+      for (auto &s : n.ring)
+        if (s.id)
+          glDeleteQueries(1, &s.id);
+      it = nodes.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool OcclusionQueries::occluded(const Key &k) const {
+  auto it = nodes.find(k);
+  if (it == nodes.end())
+    return false;
+
+  // a result older than the ring is from before the portal left the view
+  const Node &n = it->second;
+  return !n.visible && frame - n.resultFrame <= kRing + 1;
+}
+
+bool OcclusionQueries::begin(const Key &k) {
+  Node &n = nodes[k];
+  Slot &s = n.ring[n.head];
+  if (s.pending)
+    return false;
+
+  if (!s.id)
+    glGenQueries(1, &s.id);
+  glBeginQuery(target(), s.id);
+  s.pending = true;
+  s.frame = frame;
+  n.head = (n.head + 1) % kRing;
+  n.lastIssued = frame;
+  return true;
+}
+
+void OcclusionQueries::end() { glEndQuery(target()); }
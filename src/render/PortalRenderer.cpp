@@ -5,14 +5,20 @@
 #include "portal/Cell.h"
 #include "portal/Portal.h"
 #include "portal/Scene.h"
+#include "render/Frustum.h"
 #include "shape/ModelShape.h"
 #include "shape/PortalQuad.h"
 #include "shape/Skybox.h"
 #include "shape/TexturedBox.h"
 #include "shape/TexturedQuad.h"
+#include "util/GLState.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <cstdio> // debug prints
 #include <glad/glad.h>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
@@ -57,27 +63,113 @@ glm::mat4 makeObliqueProj(glm::mat4 P, const glm::vec4 &clipPlaneCam) {
 }
 
 // global state toggle -------------------------------------------------
-static void pushClip() { glEnable(GL_CLIP_DISTANCE0); }
-static void popClip() { glDisable(GL_CLIP_DISTANCE0); }
+static void pushClip() { GLState::inst().enable(GL_CLIP_DISTANCE0); }
+static void popClip() { GLState::inst().disable(GL_CLIP_DISTANCE0); }
+
+// project a (convex) quad into NDC and return its screen-space bounds; edges
+// crossing the eye plane are clipped against w = eps first so quads that
+// straddle the camera still give a conservative rect
+static PortalRect projectRect(const glm::mat4 &MVP,
+                              const std::array<glm::vec4, 4> &pts) {
+  constexpr float kMinW = 1e-4f;
+
+  std::array<glm::vec4, 8> poly;
+  int n = 0;
+  for (int i = 0; i < 4; ++i) {
+    glm::vec4 a = MVP * pts[i];
+    glm::vec4 b = MVP * pts[(i + 1) % 4];
+    bool aIn = a.w > kMinW, bIn = b.w > kMinW;
+    if (aIn)
+      poly[n++] = a;
+    if (aIn != bIn)
+      poly[n++] = a + (b - a) * ((kMinW - a.w) / (b.w - a.w));
+  }
+
+  PortalRect r{glm::vec2(INFINITY), glm::vec2(-INFINITY)};
+  for (int i = 0; i < n; ++i) {
+    glm::vec2 ndc(poly[i].x / poly[i].w, poly[i].y / poly[i].w);
+    r.lo = glm::min(r.lo, ndc);
+    r.hi = glm::max(r.hi, ndc);
+  }
+  return r.intersect(PortalRect{});
+}
+
+// portal quads live in the local XY plane, ±halfW × ±halfH
+static std::array<glm::vec4, 4> localCorners(const PortalQuad &q) {
+  float w = q.halfWidth(), h = q.halfHeight();
+  return {glm::vec4(-w, -h, 0, 1), glm::vec4(w, -h, 0, 1),
+          glm::vec4(w, h, 0, 1), glm::vec4(-w, h, 0, 1)};
+}
 
-// send <A,B,C,D> to *the shader that is bound right now*
+// the part of a portal quad that shows inside <region> of the view that
+// draws it with <MVP>, as corners of a rect in the quad's local XY: each
+// region corner is cast back onto the quad's plane. The whole quad when a
+// corner's ray leaves the view's depth range before reaching the plane.
+static std::array<glm::vec4, 4> visibleCorners(const PortalQuad &q,
+                                               const glm::mat4 &MVP,
+                                               const PortalRect &region) {
+  const std::array<glm::vec4, 4> all = localCorners(q);
+  const glm::mat4 inv = glm::inverse(MVP);
+  const glm::vec2 ndc[4] = {region.lo, glm::vec2(region.hi.x, region.lo.y),
+                            region.hi, glm::vec2(region.lo.x, region.hi.y)};
+
+  glm::vec2 lo(INFINITY), hi(-INFINITY);
+  for (const glm::vec2 &c : ndc) {
+    glm::vec4 a = inv * glm::vec4(c, -1.f, 1.f); // on the near plane
+    glm::vec4 b = inv * glm::vec4(c, 1.f, 1.f);  // ... and the far one
+    glm::vec3 an = glm::vec3(a) / a.w, bn = glm::vec3(b) / b.w;
+    if (std::abs(an.z - bn.z) < 1e-6f)
+      return all;
+    float t = an.z / (an.z - bn.z); // local z = 0
+    if (t < 0.f || t > 1.f)
+      return all;
+    glm::vec3 hit = an + (bn - an) * t;
+    lo = glm::min(lo, glm::vec2(hit.x, hit.y));
+    hi = glm::max(hi, glm::vec2(hit.x, hit.y));
+  }
+
+  lo = glm::max(lo, glm::vec2(all[0].x, all[0].y));
+  hi = glm::min(hi, glm::vec2(all[2].x, all[2].y));
+  if (lo.x >= hi.x || lo.y >= hi.y)
+    return all;
+  return {glm::vec4(lo.x, lo.y, 0, 1), glm::vec4(hi.x, lo.y, 0, 1),
+          glm::vec4(hi.x, hi.y, 0, 1), glm::vec4(lo.x, hi.y, 0, 1)};
+}
 
-static inline void setClipPlane(GLint loc, const glm::vec4 &eq) {
-  if (loc >= 0) // shader actually has the uniform
-    glUniform4fv(loc, 1, &eq.x);
+// bind a render target and restrict rasterisation to <region> of it
+void PortalRenderer::bindTarget(GLuint fbo, int w, int h,
+                                const PortalRect &region) {
+  curFbo = fbo;
+  curW = w;
+  curH = h;
+  GLState &gl = GLState::inst();
+  gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+  gl.viewport(0, 0, w, h);
+
+  int x0 = int(std::floor((region.lo.x * 0.5f + 0.5f) * w));
+  int y0 = int(std::floor((region.lo.y * 0.5f + 0.5f) * h));
+  int x1 = int(std::ceil((region.hi.x * 0.5f + 0.5f) * w));
+  int y1 = int(std::ceil((region.hi.y * 0.5f + 0.5f) * h));
+  gl.enable(GL_SCISSOR_TEST);
+  gl.scissor(x0, y0, x1 - x0, y1 - y0);
 }
 
 //------------------------------------------------------------------------------
 // PortalRenderer::renderPortal
+// Returns whether the opening is on screen (and so should be occlusion-
+// queried once the cell's geometry is in the depth buffer).
 // Renders the “view‐through” for one portal by
+//  • rejecting it if its screen rect misses the parent's region,
 //  • building an oblique‐clipped camera,
-//  • drawing the destination cell into an offscreen FBO,
+//  • drawing the destination cell into an offscreen FBO, scissored to the
+//    part of the texture the quad actually samples,
 //  • then texturing that FBO back onto the source quad.
 //------------------------------------------------------------------------------
-void PortalRenderer::renderPortal(Portal &portal, const Camera &camSrc,
-                                  int depth) {
+bool PortalRenderer::renderPortal(Portal &portal, const Camera &camSrc,
+                                  int depth, const PortalRect &parentRegion) {
   if (depth <= 0)
-    return;
+    return false;
+  ++frameStats.viewNodes;
 
   // 1) source portal quad
   auto &srcQuad = static_cast<PortalQuad &>(portal.getSurface());
@@ -86,128 +178,295 @@ void PortalRenderer::renderPortal(Portal &portal, const Camera &camSrc,
   {
     glm::vec3 N = normalize(srcQuad.normal());
     glm::vec3 toCam = normalize(srcQuad.c() - camSrc.Position);
-    if (dot(N, toCam) > 0.0f)
-      return;
+    if (dot(N, toCam) > 0.0f) {
+      ++frameStats.portalsCulled;
+      return false;
+    }
+  }
+
+  // source view & projection (also used to draw the quad itself so its frame
+  // lines up with the scene)
+  glm::mat4 Vsrc = camSrc.GetViewMatrix();
+  glm::mat4 Psrc = glm::perspective(glm::radians(camSrc.Zoom),
+                                    float(screenW) / screenH, 0.1f, 100.f);
+
+  // 2b) screen-space cull: the opening must overlap what the parent shows
+  auto corners = localCorners(srcQuad);
+  PortalRect srcRect = projectRect(Psrc * Vsrc * srcQuad.model(), corners)
+                           .intersect(parentRegion);
+  if (srcRect.empty()) {
+    ++frameStats.portalsCulled;
+    return false;
   }
 
   // 3) destination portal
   Portal *dstP = portal.getDestinationPortal();
   if (!dstP)
-    return;
+    return false;
   auto &dstQuad = static_cast<PortalQuad &>(dstP->getSurface());
 
-  // 4) pick next FBO
-  static int passIdx = 0;
-  PortalPass &pp = portalPasses[passIdx++];
-  if (passIdx >= portalPasses.size())
-    passIdx = 0;
+  // 3b) nothing of it survived the depth test last time we looked
+  if (options.occlusionQueries && occlusion.occluded({&portal, stencilDepth})) {
+    ++frameStats.portalsOccluded;
+    return true;
+  }
 
-  // 5) build the “through‐portal” camera
+  // 4) build the “through‐portal” camera
   glm::vec3 dstCenter = dstQuad.c();
   bool flip = portal.getFlipView();
   Camera camDst =
       throughPortalFixed(camSrc, portal.transform(), dstCenter, flip);
   glm::mat4 Vdst = camDst.GetViewMatrix();
 
-  // 6) build the clip‐plane in camera‐space
+  // 5) the destination portal's plane in world space
   glm::vec3 clipN = normalize(dstQuad.normal());
   glm::vec3 clipP = dstQuad.c();
   glm::vec4 planeW(clipN, -dot(clipN, clipP));
-  glm::vec4 clipPlaneCam = transpose(inverse(Vdst)) * planeW;
 
-  // 7) build an oblique projection
-  float aspect = float(pp.width) / pp.height;
+  // 6) the destination view's projection
+  float aspect = float(screenW) / screenH;
   glm::mat4 P =
       glm::perspective(glm::radians(camDst.Zoom), aspect, 0.1f, 100.f);
-  glm::mat4 Pdst = makeObliqueProj(P, clipPlaneCam);
 
-  // 8) render destination cell into offscreen FBO
-  glBindFramebuffer(GL_FRAMEBUFFER, pp.fbo);
-  GLenum drawBufs[1] = {GL_COLOR_ATTACHMENT0};
-  glDrawBuffers(1, drawBufs);
-  glViewport(0, 0, pp.width, pp.height);
-  glEnable(GL_DEPTH_TEST);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  // 6b) the quad samples portalTex through the uPortalVP that PortalQuad
+  //     uploads itself, so only that rect of the destination view can ever
+  //     reach the screen - and of it, only what the part of the quad inside
+  //     srcRect samples; the view recurses with that narrowed region
+  const glm::mat4 &texVP = srcQuad.getPortalVP();
+  PortalRect dstRect =
+      projectRect(texVP, corners)
+          .intersect(projectRect(
+              texVP, visibleCorners(srcQuad, Psrc * Vsrc * srcQuad.model(),
+                                    srcRect)));
+  if (dstRect.empty()) {
+    ++frameStats.portalsCulled;
+    return false;
+  }
+  ++frameStats.portalsDrawn;
+
+  // 6c) frame budget: the view competes on projected area and depth
+  PortalScheduler::Key key{&portal, stencilDepth};
+  float priority = curPriority * srcRect.coverage() * kDepthPriority;
+  scheduler.record(key, curKey, priority);
+  bool admitted = !options.frameBudget || scheduler.admitted(key);
+
+  // 7) reserve a target for this node (held until we've composited it below)
+  //    and render the destination cell into it
+  GLuint parentFbo = curFbo;
+  int parentW = curW, parentH = curH;
+  int parentCamera = cameras.current();
+  PortalPass *pp = nullptr;
+  AdaptiveTarget *history = nullptr; // set when last frame's view is reused
+  AdaptiveTarget *drawn = nullptr;   // set when an adaptive target is redrawn
+  bool flatFill = false;             // not admitted and nothing to reuse
+  glm::mat4 viewVP = P * Vdst;       // what renderCell draws the cell with
+  GLuint fbo = 0, colorTex = 0;
+  int fbW = 0, fbH = 0;
+  const ViewMemo *same = nullptr;
+  if (options.adaptiveResolution && options.memoizeViews)
+    same = findView(&portal, depth - 1, Vdst, camDst.Zoom, dstRect);
+  if (same) {
+    // an equivalent view was already rendered this frame
+    ++frameStats.viewsShared;
+    colorTex = same->target->fb.colorTex();
+  } else if (options.adaptiveResolution) {
+    AdaptiveTarget &at = adaptive[key];
+    if (at.lastFrame != frameNo) {
+      at.lastVisits = at.visits;
+      at.visits = 0;
+      at.lastFrame = frameNo;
+    }
+    ++at.visits;
+    at.shared = at.visits > 1 || at.lastVisits > 1;
+
+    bool haveHistory = at.historyValid && !at.shared;
+    unsigned content = contentSerial(*portal.destination(), depth - 1);
+    if (!admitted) {
+      history = haveHistory ? &at : nullptr;
+      flatFill = !haveHistory;
+    } else if (options.temporalReuse && canReuse(at, camDst, content)) {
+      history = &at;
+    } else {
+      // texels needed ≈ pixels the opening covers on the parent target,
+      // spread over the part of the texture that is sampled
+      float parentFrac = float(parentW) * parentH / (float(screenW) * screenH);
+      float bias = std::pow(kDepthScale, float(stencilDepth));
+      float frac = srcRect.coverage() * parentFrac /
+                   std::max(dstRect.coverage(), 1e-4f) * bias * bias;
+
+      at.fb.setBaseSize(screenW, screenH);
+      at.fb.setTargetFraction(frac);
+
+      at.historyValid = true;
+      at.historyFrame = frameNo;
+      at.historyContent = content;
+      at.historyVP = viewVP;
+      at.historyPos = camDst.Position;
+      at.historyFront = camDst.Front;
+      at.historyW = at.fb.width();
+      at.historyH = at.fb.height();
+      ++at.renderSerial;
+      drawn = &at;
+    }
+    fbo = at.fb.framebuffer();
+    colorTex = at.fb.colorTex();
+    fbW = at.fb.width();
+    fbH = at.fb.height();
+  } else if (!admitted) {
+    flatFill = true;
+  } else {
+    pp = targets.acquire(screenW, screenH);
+    fbo = pp->fbo;
+    colorTex = pp->colorTex;
+    fbW = pp->width;
+    fbH = pp->height;
+  }
+
+  bool render = !same && !history && !flatFill;
+  if (!admitted && !same)
+    ++frameStats.portalsDeferred;
+
+  if (history) {
+    ++frameStats.portalsReused;
+  } else if (render) {
+    int timer = scheduler.beginTiming(key);
+
+    frameStats.portalTexels += double(fbW) * fbH * dstRect.coverage();
+    frameStats.portalTexelsFull +=
+        double(screenW) * screenH * dstRect.coverage();
 
-  // ** now use the oblique projection & clip‐plane to cull everything behind **
-  //    (no extra gl_ClipDistance needed—oblique proj does it for you)
-  renderCell(*portal.destination(), camDst, depth - 1, &portal);
+    bindTarget(fbo, fbW, fbH, dstRect);
+    GLenum drawBufs[1] = {GL_COLOR_ATTACHMENT0};
+    glDrawBuffers(1, drawBufs);
+    GLState::inst().enable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    PortalScheduler::Key parentKey = curKey;
+    float parentPriority = curPriority;
+    curKey = key;
+    curPriority = priority;
+    // the view's Camera block carries the destination plane, its normal
+    // along the view direction: the camera sits on the plane, so only what
+    // lies behind the portal it looks out of is dropped
+    glm::vec4 parentClip = clipEq;
+    clipEq = dot(clipN, camDst.Front) < 0.f ? -planeW : planeW;
+    ++stencilDepth;
+    renderCell(*portal.destination(), camDst, depth - 1, &portal, dstRect);
+    --stencilDepth;
+    clipEq = parentClip;
+    curKey = parentKey;
+    curPriority = parentPriority;
+
+    scheduler.endTiming(key, timer);
+
+    if (drawn && options.memoizeViews)
+      views.push_back({&portal, depth - 1, Vdst, camDst.Zoom, dstRect, drawn,
+                       drawn->renderSerial});
+  }
 
-  // 9) restore default framebuffer
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  glViewport(0, 0, screenW, screenH);
+  // 8) restore the parent's target, region and camera
+  if (render) {
+    bindTarget(parentFbo, parentW, parentH, parentRegion);
+    cameras.bind(parentCamera);
+  }
 
-  // 10) draw the source quad with the rendered texture
+  // 9) draw the source quad with the rendered texture
+  GLState &gl = GLState::inst();
   srcQuad.shader()->use();
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, pp.colorTex);
+  gl.activeTexture(GL_TEXTURE0);
+  gl.bindTexture(GL_TEXTURE_2D, colorTex);
   srcQuad.shader()->setInt("portalTex", 0);
 
-  // feed it the original view & projection so the frame of the portal itself
-  // lines up with the scene
-  glm::mat4 Vsrc = camSrc.GetViewMatrix();
-  glm::mat4 Psrc = glm::perspective(glm::radians(camSrc.Zoom),
-                                    float(screenW) / screenH, 0.1f, 100.f);
-  srcQuad.shader()->setMat4("uModel", srcQuad.model());
-  srcQuad.shader()->setMat4("uView", Vsrc);
-  srcQuad.shader()->setMat4("uProj", Psrc);
+  // a reused texture is warped by its depth towards this frame's view
+  srcQuad.shader()->setBool("uFill", flatFill);
+  srcQuad.shader()->setBool("uReproject", history != nullptr);
+  if (history) {
+    gl.activeTexture(GL_TEXTURE1);
+    gl.bindTexture(GL_TEXTURE_2D, history->fb.depthTex());
+    srcQuad.shader()->setInt("portalDepth", 1);
+    srcQuad.shader()->setMat4("uHistoryInvVP",
+                              glm::inverse(history->historyVP));
+    srcQuad.shader()->setMat4("uCurrentVP", viewVP);
+    gl.activeTexture(GL_TEXTURE0);
+  }
 
-  // and hand it the portal‐camera’s VP so it can do the 2D uv =
-  // clipPos.xy/clipPos.w*0.5+0.5
-  srcQuad.shader()->setMat4("uPortalVP", Pdst * Vdst);
+  // render() uploads the quad's own uPortalVP (see PortalQuad::setPortalVP)
+  srcQuad.render();
 
-  srcQuad.setViewProj(camSrc.GetViewMatrix(),
-                      glm::perspective(glm::radians(camSrc.Zoom),
-                                       float(screenW) / screenH, 0.1f, 100.f));
+  if (pp)
+    targets.release(pp);
+  return true;
+}
 
-  srcQuad.render();
+// an earlier node of this frame rendered the same cell from the same camera
+// with as much depth left, covering at least <rect>, and its target hasn't
+// been redrawn since
+const PortalRenderer::ViewMemo *
+PortalRenderer::findView(const Portal *entry, int depth, const glm::mat4 &V,
+                         float zoom, const PortalRect &rect) const {
+  constexpr float kEps = 1e-4f;
+
+  for (const ViewMemo &m : views) {
+    if (m.entry != entry || m.depth != depth || m.zoom != zoom)
+      continue;
+    if (m.serial != m.target->renderSerial)
+      continue;
+    if (rect.lo.x < m.rect.lo.x || rect.lo.y < m.rect.lo.y ||
+        rect.hi.x > m.rect.hi.x || rect.hi.y > m.rect.hi.y)
+      continue;
+
+    bool sameView = true;
+    for (int c = 0; c < 4; ++c)
+      for (int r = 0; r < 4; ++r)
+        sameView = sameView && std::abs(V[c][r] - m.view[c][r]) <= kEps;
+    if (sameView)
+      return &m;
+  }
+  return nullptr;
+}
+
+// last frame's texture may stand in for this view if the destination camera
+// has barely moved, nothing it shows has changed and the texture isn't too old
+bool PortalRenderer::canReuse(const AdaptiveTarget &at, const Camera &camDst,
+                              unsigned content) const {
+  if (!at.historyValid || at.shared)
+    return false;
+  if (frameNo - at.historyFrame > options.maxStaleFrames)
+    return false;
+  if (at.historyContent != content)
+    return false;
+  if (at.historyW != at.fb.width() || at.historyH != at.fb.height())
+    return false;
+
+  float moved = glm::length(camDst.Position - at.historyPos);
+  float cosTurn = glm::dot(glm::normalize(camDst.Front), at.historyFront);
+  return moved <= options.reuseMaxMove &&
+         cosTurn >= std::cos(glm::radians(options.reuseMaxAngle));
+}
+
+unsigned PortalRenderer::contentSerial(const Cell &cell, int depth) {
+  unsigned s = cell.changeSerial();
+  for (auto &p : cell.getPortals()) {
+    s += p->getSurface().changeSerial();
+    if (depth > 0 && p->destination())
+      s += contentSerial(*p->destination(), depth - 1);
+  }
+  return s;
 }
 
 void PortalRenderer::init(int w, int h) {
   screenW = w;
   screenH = h;
 
-  portalPasses.resize(2);
-  for (auto &pp : portalPasses) {
-    pp.width = screenW; // Match screen dimensions
-    pp.height = screenH;
-    // 1) color texture
-    glGenTextures(1, &pp.colorTex);
-    glBindTexture(GL_TEXTURE_2D, pp.colorTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pp.width, pp.height, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // 2) depth renderbuffer
-    glGenRenderbuffers(1, &pp.depthRb);
-    glBindRenderbuffer(GL_RENDERBUFFER, pp.depthRb);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, pp.width,
-                          pp.height);
-
-    // 3) create & bind FBO
-    glGenFramebuffers(1, &pp.fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, pp.fbo);
-
-    // 4) attach your textures
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           pp.colorTex, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                              GL_RENDERBUFFER, pp.depthRb);
-
-    // 5) *here* is the magic bit*
-    GLenum drawBufs[1] = {GL_COLOR_ATTACHMENT0};
-    glDrawBuffers(1, drawBufs);
-
-    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
-  }
-
-  // back to default
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  // old-size targets are dropped now; new ones are allocated on first use
+  targets.trim();
+  adaptive.clear();
+  views.clear();
 }
 
 void PortalRenderer::renderScene(const Scene &scene, const Camera &cam,
-                                 int maxDepth) {
+                                 int maxDepth, PortalMode mode,
+                                 const PortalOptions &opts) {
   if (!scene.viewpointCell())
     return;
 
@@ -215,41 +474,302 @@ void PortalRenderer::renderScene(const Scene &scene, const Camera &cam,
   glClear(GL_STENCIL_BUFFER_BIT);
 
   stencilDepth = 0;
-  renderCell(*scene.viewpointCell(), cam, maxDepth, nullptr);
+  frameStats = {};
+  options = opts;
+  ++frameNo;
+  targets.beginFrame();
+  occlusion.beginFrame(frameNo);
+  cameras.beginFrame();
+  for (auto &[cell, batch] : batches)
+    batch->beginFrame();
+  scheduler.beginFrame(opts.frameBudget ? opts.frameBudgetMs : 1e9f);
+  curKey = PortalScheduler::kRoot;
+  curPriority = 1.f;
+  views.clear();
+  for (auto it = adaptive.begin(); it != adaptive.end();) {
+    if (frameNo - it->second.lastFrame > kAdaptiveIdleFrames)
+      it = adaptive.erase(it);
+    else
+      ++it;
+  }
+
+  PortalRect full;
+  bindTarget(0, screenW, screenH, full);
+
+  GLState &gl = GLState::inst();
+  if (mode == PortalMode::Stencil) {
+    baseProj = glm::perspective(glm::radians(cam.Zoom),
+                                float(screenW) / screenH, 0.1f, 100.f);
+    renderCellStencil(*scene.viewpointCell(), cam.GetViewMatrix(), baseProj,
+                      cam.Position, maxDepth, nullptr, full);
+
+    // leave GL the way the rest of the frame expects it
+    gl.disable(GL_STENCIL_TEST);
+    gl.stencilMask(0xFF);
+    gl.colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    gl.depthMask(GL_TRUE);
+    gl.depthFunc(GL_LESS);
+  } else {
+    renderCell(*scene.viewpointCell(), cam, maxDepth, nullptr, full);
+  }
+  gl.disable(GL_SCISSOR_TEST);
+
+  frameStats.portalPlannedMs = scheduler.plannedMs();
+  frameStats.targetsPeak = targets.peakInUse();
+  frameStats.targetsAllocated = targets.allocated();
 }
 
 // ── generic cell draw: first its portals, then its geometry ───────
 void PortalRenderer::renderCell(const Cell &cell, const Camera &cam, int depth,
-                                const Portal *cameFrom) {
-  // 1. recurse into portals as you already do…
+                                const Portal *cameFrom,
+                                const PortalRect &region) {
+  // 0. this view's camera, for everything drawn in it (nested views bind
+  //    their own and rebind this one when they're done)
+  glm::mat4 V = cam.GetViewMatrix();
+  glm::mat4 P = glm::perspective(glm::radians(cam.Zoom),
+                                 float(screenW) / screenH, 0.1f, 100.f);
+  cameras.push(V, P, cam.Position, clipEq);
+
+  // 1. recurse into portals visible inside <region>
+  std::vector<Portal *> onScreen;
   if (depth > 0) {
     for (auto &p : cell.getPortals())
-      if (p.get() != cameFrom)
-        renderPortal(*p, cam, depth - 1);
+      if (p.get() != cameFrom && renderPortal(*p, cam, depth - 1, region))
+        onScreen.push_back(p.get());
   }
 
   // 2. draw this cell’s own geometry
-  glm::mat4 V = cam.GetViewMatrix();
-  glm::mat4 P = glm::perspective(glm::radians(cam.Zoom),
-                                 float(screenW) / screenH, 0.1f, 100.f);
-  glm::vec3 eye = cam.Position;
+  drawGeometry(cell, V, P, region);
+
+  // 3. with occluders in depth, test the openings for next frame
+  queryOpenings(onScreen);
+}
+
+// depth-tested, write-nothing draw of each opening inside an occlusion query
+void PortalRenderer::queryOpenings(const std::vector<Portal *> &portals) {
+  if (!options.occlusionQueries || portals.empty())
+    return;
+
+  GLState &gl = GLState::inst();
+  gl.colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  gl.depthMask(GL_FALSE);
+  gl.enable(GL_DEPTH_TEST);
+  gl.depthFunc(GL_LEQUAL); // the composited quad already wrote this depth
+
+  for (Portal *p : portals) {
+    auto &quad = static_cast<PortalQuad &>(p->getSurface());
+    if (occlusion.begin({p, stencilDepth})) {
+      quad.render();
+      occlusion.end();
+    }
+  }
+
+  gl.depthFunc(GL_LESS);
+  gl.depthMask(GL_TRUE);
+  gl.colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+StaticBatch *PortalRenderer::batchFor(const Cell &cell) {
+  if (!options.indirectDraw || !StaticBatch::supported() ||
+      cell.getStatic().empty())
+    return nullptr;
+  auto &batch = batches[&cell];
+  // rebuilt when static geometry was added since
+  if (!batch || batch->builtFrom() != cell.getStatic().size()) {
+    if (!batch)
+      batch = std::make_unique<StaticBatch>();
+    batch->build(cell.getStatic());
+  }
+  return batch.get();
+}
+
+void PortalRenderer::drawGeometry(const Cell &cell, const glm::mat4 &V,
+                                  const glm::mat4 &P,
+                                  const PortalRect &region) {
+  Frustum frustum(P * V, region.lo, region.hi);
+  PortalViewStats vs;
+  vs.level = stencilDepth;
+  drawList.begin(glm::vec3(glm::inverse(V)[3]), 100.f);
+  // a nested view is seen smaller (and through a scaled-down target), so
+  // its models drop to coarser levels sooner
+  if (options.meshLod)
+    drawList.setDetail(0.5f * P[1][1] * float(screenH) *
+                       std::pow(kDepthDetail, float(stencilDepth)));
+
+  // the compiled static set goes in whole: it isn't sorted, and culled (if
+  // at all) on the GPU, so it all counts as drawn here
+  StaticBatch *batch = batchFor(cell);
+  if (batch)
+    vs.drawn += batch->shapes();
 
   for (auto &g : cell.getGeometry()) {
     if (dynamic_cast<PortalQuad *>(g.get()))
       continue;
+    if (batch && batch->covers(g.get()))
+      continue;
 
-    if (auto *m = dynamic_cast<ModelShape *>(g.get())) {
-      m->setViewProj(V, P, eye);
-    } else if (auto *q = dynamic_cast<TexturedQuad *>(g.get())) {
-      q->setViewProj(V, P);
-    } else if (auto *sky = dynamic_cast<Skybox *>(g.get())) {
-      sky->setViewProj(V, P);
-    } else if (auto *box = dynamic_cast<TexturedBox *>(g.get())) {
-      box->setViewProj(V, P);
+    if (options.frustumCulling && !frustum.intersects(g->bounds())) {
+      ++vs.culled;
+      continue;
     }
+    ++vs.drawn;
+    g->emit(drawList);
+  }
 
-    g->render();
+  // sorted by program / texture / VAO; the camera comes from the bound
+  // Camera block
+  const long long trianglesBefore = frameStats.draws.triangles;
+  if (batch && options.gpuCulling && options.frustumCulling &&
+      StaticBatch::cullingSupported())
+    batch->submitCulled(frameStats.draws, region.lo, region.hi);
+  else if (batch)
+    batch->submit(frameStats.draws);
+  drawList.submit(frameStats.draws);
+  vs.triangles = frameStats.draws.triangles - trianglesBefore;
+
+  // last, at the far plane: only the pixels nothing covered get shaded
+  if (Skybox *sky = cell.getSky())
+    sky->render();
+
+  frameStats.objectsDrawn += vs.drawn;
+  frameStats.objectsCulled += vs.culled;
+  frameStats.perView.push_back(vs);
+}
+
+//------------------------------------------------------------------------------
+// PortalRenderer::renderCellStencil
+// Stencil-buffer recursion: every opening visible at level L is marked by
+// incrementing the stencil from L to L+1, the destination is drawn where the
+// stencil equals L+1, and the mark is decremented again. Afterwards the
+// portal quads are written into depth only, so this level's geometry (drawn
+// where stencil == L) is correctly occluded by – and occludes – the openings.
+//------------------------------------------------------------------------------
+void PortalRenderer::renderCellStencil(const Cell &cell, const glm::mat4 &V,
+                                       const glm::mat4 &P, const glm::vec3 &eye,
+                                       int maxDepth, const Portal *cameFrom,
+                                       const PortalRect &region) {
+  const int level = stencilDepth;
+  const int camera = cameras.push(V, P, eye, clipEq);
+
+  // 1) collect openings that are front-facing and inside <region>
+  struct Opening {
+    Portal *portal;
+    PortalQuad *quad;
+    PortalRect rect;
+    float dist2;
+  };
+  std::vector<Opening> open;
+  std::vector<Portal *> onScreen;
+  if (level < maxDepth) {
+    for (auto &p : cell.getPortals()) {
+      if (p.get() == cameFrom || !p->getDestinationPortal())
+        continue;
+      auto &quad = static_cast<PortalQuad &>(p->getSurface());
+
+      glm::vec3 toQuad = quad.c() - eye;
+      if (dot(quad.normal(), toQuad) > 0.0f) {
+        ++frameStats.portalsCulled;
+        continue;
+      }
+      PortalRect r = projectRect(P * V * quad.model(), localCorners(quad))
+                         .intersect(region);
+      if (r.empty()) {
+        ++frameStats.portalsCulled;
+        continue;
+      }
+      onScreen.push_back(p.get());
+      if (options.occlusionQueries && occlusion.occluded({p.get(), level})) {
+        ++frameStats.portalsOccluded;
+        continue;
+      }
+      open.push_back({p.get(), &quad, r, dot(toQuad, toQuad)});
+    }
   }
+
+  // far → near, so overlapping openings at the same level resolve correctly
+  std::sort(open.begin(), open.end(), [](const Opening &a, const Opening &b) {
+    return a.dist2 > b.dist2;
+  });
+
+  GLState &gl = GLState::inst();
+  gl.enable(GL_STENCIL_TEST);
+  for (auto &o : open) {
+    ++frameStats.portalsDrawn;
+    PortalQuad &quad = *o.quad;
+    Portal *dstP = o.portal->getDestinationPortal();
+    auto &dstQuad = static_cast<PortalQuad &>(dstP->getSurface());
+
+    // a) mark the opening: L → L+1
+    bindTarget(0, screenW, screenH, o.rect);
+    gl.colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    gl.depthMask(GL_FALSE);
+    gl.disable(GL_DEPTH_TEST);
+    gl.stencilMask(0xFF);
+    gl.stencilFunc(GL_NOTEQUAL, level, 0xFF);
+    gl.stencilOp(GL_INCR, GL_KEEP, GL_KEEP);
+    quad.render();
+
+    // b) destination view – the true portal transform, since the result is
+    //    composited in screen space rather than resampled from a texture
+    glm::mat4 T = o.portal->transform();
+    if (o.portal->getFlipView()) {
+      glm::vec3 c = dstQuad.c();
+      glm::vec3 up = glm::normalize(glm::vec3(dstQuad.model()[1]));
+      T = glm::translate(glm::mat4(1.f), c) *
+          glm::rotate(glm::mat4(1.f), glm::pi<float>(), up) *
+          glm::translate(glm::mat4(1.f), -c) * T;
+    }
+    glm::mat4 Vdst = V * glm::inverse(T);
+    glm::vec3 eyeDst = glm::vec3(T * glm::vec4(eye, 1.f));
+
+    // oblique near plane on the destination portal; Lengyel needs the eye on
+    // the plane's negative side
+    glm::vec4 planeW(dstQuad.normal(), dstQuad.planeD());
+    if (dot(planeW, glm::vec4(eyeDst, 1.f)) > 0.0f)
+      planeW = -planeW;
+    glm::mat4 Pdst =
+        makeObliqueProj(baseProj, transpose(inverse(Vdst)) * planeW);
+
+    ++stencilDepth;
+    renderCellStencil(*o.portal->destination(), Vdst, Pdst, eyeDst, maxDepth,
+                      dstP, o.rect);
+    --stencilDepth;
+
+    // c) unmark: L+1 → L
+    cameras.bind(camera);
+    bindTarget(0, screenW, screenH, o.rect);
+    gl.enable(GL_STENCIL_TEST);
+    gl.colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    gl.depthMask(GL_FALSE);
+    gl.disable(GL_DEPTH_TEST);
+    gl.stencilMask(0xFF);
+    gl.stencilFunc(GL_NOTEQUAL, level + 1, 0xFF);
+    gl.stencilOp(GL_DECR, GL_KEEP, GL_KEEP);
+    quad.render();
+  }
+
+  // 2) reset depth for this view and lay down the openings' depth
+  bindTarget(0, screenW, screenH, region);
+  gl.disable(GL_STENCIL_TEST);
+  gl.stencilMask(0x00);
+  gl.colorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  gl.enable(GL_DEPTH_TEST);
+  gl.depthMask(GL_TRUE);
+  gl.depthFunc(GL_ALWAYS);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  for (auto &o : open)
+    o.quad->render();
+  gl.depthFunc(GL_LESS);
+
+  // 3) this level's geometry, only where the stencil says we are at level L
+  gl.enable(GL_STENCIL_TEST);
+  gl.stencilFunc(GL_EQUAL, level, 0xFF);
+  gl.stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+  gl.colorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  drawGeometry(cell, V, P, region);
+
+  // 4) test the openings against this level's depth for next frame
+  queryOpenings(onScreen);
 }
 
 void PortalUtils::checkPortalTeleport(Scene &scene, Camera &cam) {
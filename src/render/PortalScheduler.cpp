@@ -0,0 +1,123 @@
+#include "render/PortalScheduler.h"
+#include <algorithm>
+
+PortalScheduler::~PortalScheduler() {
+  for (auto &kv : timings)
+    for (auto &s : kv.second.ring)
+      if (s.q[0])
+        glDeleteQueries(2, s.q);
+}
+
+void PortalScheduler::beginFrame(float budgetMs) {
+  ++frame;
+
+  // 1) collect finished timings, drop keys that haven't been seen for a while
+  for (auto it = timings.begin(); it != timings.end();) {
+    Timing &t = it->second;
+    bool busy = false;
+    for (auto &s : t.ring) {
+      if (!s.pending)
+        continue;
+      GLint ready = 0;
+      glGetQueryObjectiv(s.q[1], GL_QUERY_RESULT_AVAILABLE, &ready);
+      if (!ready) {
+        busy = true;
+        continue;
+      }
+      GLuint64 t0 = 0, t1 = 0;
+      glGetQueryObjectui64v(s.q[0], GL_QUERY_RESULT, &t0);
+      glGetQueryObjectui64v(s.q[1], GL_QUERY_RESULT, &t1);
+      t.ms = float(double(t1 - t0) * 1e-6);
+      s.pending = false;
+    }
+
+    if (!busy && frame - t.lastUsed > kEvictFrames) {
+      for (auto &s : t.ring)
+        if (s.q[0])
+          glDeleteQueries(2, s.q);
+      it = timings.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // 2) exclusive cost = own inclusive time minus the children's
+  auto inclusive = [this](const Key &k) {
+    auto it = timings.find(k);
+    return it == timings.end() ? -1.f : it->second.ms;
+  };
+  std::map<Key, float> childMs;
+  std::set<std::pair<Key, Key>> edges;
+  for (auto &c : candidates)
+    if (edges.insert({c.parent, c.key}).second)
+      childMs[c.parent] += std::max(inclusive(c.key), 0.f);
+
+  // 3) a child can never outrank its parent
+  std::map<Key, float> effective;
+  for (auto &c : candidates) {
+    auto p = effective.find(c.parent);
+    float pr = p == effective.end() ? c.priority
+                                    : std::min(c.priority, p->second);
+    auto &e = effective[c.key];
+    e = std::max(e, pr);
+  }
+
+  std::vector<Candidate> order = candidates;
+  for (auto &c : order)
+    c.priority = std::min(c.priority, effective[c.key]);
+  std::stable_sort(order.begin(), order.end(),
+                   [](const Candidate &a, const Candidate &b) {
+                     return a.priority > b.priority;
+                   });
+
+  // 4) admit in priority order while the budget lasts
+  admit.clear();
+  known.clear();
+  float spent = 0.f;
+  for (auto &c : order) {
+    if (!known.insert(c.key).second)
+      continue;
+    if (c.parent != kRoot && !admit.count(c.parent))
+      continue;
+
+    float ms = inclusive(c.key);
+    float cost = ms < 0.f ? 0.f : std::max(ms - childMs[c.key], 0.f);
+    if (spent + cost > budgetMs)
+      continue;
+    spent += cost;
+    admit.insert(c.key);
+  }
+  lastSpentMs = spent;
+  candidates.clear();
+}
+
+void PortalScheduler::record(const Key &k, const Key &parent, float priority) {
+  candidates.push_back({k, parent, priority});
+}
+
+bool PortalScheduler::admitted(const Key &k) const {
+  return !known.count(k) || admit.count(k);
+}
+
+int PortalScheduler::beginTiming(const Key &k) {
+  Timing &t = timings[k];
+  t.lastUsed = frame;
+  Slot &s = t.ring[t.head];
+  if (s.pending)
+    return -1;
+
+  if (!s.q[0])
+    glGenQueries(2, s.q);
+  glQueryCounter(s.q[0], GL_TIMESTAMP);
+  int handle = t.head;
+  t.head = (t.head + 1) % kRing;
+  return handle;
+}
+
+void PortalScheduler::endTiming(const Key &k, int handle) {
+  if (handle < 0)
+    return;
+  Slot &s = timings[k].ring[handle];
+  glQueryCounter(s.q[1], GL_TIMESTAMP);
+  s.pending = true;
+}
@@ -0,0 +1,102 @@
+#include "render/RenderTargetPool.h"
+#include "render/FramebufferUtils.h"
+#include "util/GLState.h"
+#include <algorithm>
+#include <cassert>
+
+RenderTargetPool::~RenderTargetPool() {
+  for (auto &pp : passes)
+    destroy(*pp);
+}
+
+PortalPass *RenderTargetPool::acquire(int w, int h, GLenum colorFormat) {
+  PortalPass *pass = nullptr;
+  for (auto &pp : passes) {
+    if (!pp->inUse && pp->width == w && pp->height == h &&
+        pp->format == colorFormat) {
+      pass = pp.get();
+      break;
+    }
+  }
+
+  if (!pass) {
+    passes.emplace_back(std::make_unique<PortalPass>());
+    pass = passes.back().get();
+    pass->width = w;
+    pass->height = h;
+    pass->format = colorFormat;
+    create(*pass);
+  }
+
+  pass->inUse = true;
+  pass->idleFrames = 0;
+  peak = std::max(peak, ++used);
+  return pass;
+}
+
+void RenderTargetPool::release(PortalPass *pass) {
+  assert(pass && pass->inUse);
+  pass->inUse = false;
+  --used;
+}
+
+void RenderTargetPool::beginFrame() {
+  peak = used;
+
+  // anything not requested for a while is at a stale size/format
+  auto stale = [](const std::unique_ptr<PortalPass> &pp) {
+    if (pp->inUse || ++pp->idleFrames <= kMaxIdleFrames)
+      return false;
+    destroy(*pp);
+    return true;
+  };
+  passes.erase(std::remove_if(passes.begin(), passes.end(), stale),
+               passes.end());
+}
+
+void RenderTargetPool::trim() {
+  auto idle = [](const std::unique_ptr<PortalPass> &pp) {
+    if (pp->inUse)
+      return false;
+    destroy(*pp);
+    return true;
+  };
+  passes.erase(std::remove_if(passes.begin(), passes.end(), idle),
+               passes.end());
+}
+
+void RenderTargetPool::create(PortalPass &pp) {
+  // 1) color texture
+  pp.colorTex = fb::makeColorTex(pp.width, pp.height, pp.format);
+
+  // 2) depth renderbuffer
+  glGenRenderbuffers(1, &pp.depthRb);
+  glBindRenderbuffer(GL_RENDERBUFFER, pp.depthRb);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, pp.width,
+                        pp.height);
+
+  // 3) create & bind FBO, attach
+  GLint prevFbo = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+  glGenFramebuffers(1, &pp.fbo);
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, pp.fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         pp.colorTex, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                            GL_RENDERBUFFER, pp.depthRb);
+
+  GLenum drawBufs[1] = {GL_COLOR_ATTACHMENT0};
+  glDrawBuffers(1, drawBufs);
+
+  assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+  // targets may be created mid-traversal: put the caller's FBO back
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, GLuint(prevFbo));
+}
+
+void RenderTargetPool::destroy(PortalPass &pp) {
+  GLState::inst().deleteFramebuffers(1, &pp.fbo);
+  GLState::inst().deleteTextures(1, &pp.colorTex);
+  glDeleteRenderbuffers(1, &pp.depthRb);
+  pp.fbo = pp.colorTex = pp.depthRb = 0;
+}
@@ -18,7 +18,8 @@ void Renderer::draw(const Scene &scene, const Camera &cam) {
   glClearColor(0.05f, 0.05f, 0.08f, 1);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-  portalRenderer->renderScene(scene, cam, recursionDepth);
+  portalRenderer->renderScene(scene, cam, recursionDepth, portalMode,
+                              portalOptions);
 }
 
 void Renderer::resize(int newW, int newH) {
@@ -0,0 +1,270 @@
+#include "render/StaticBatch.h"
+#include "render/DrawList.h"
+#include "render/GeometryArena.h"
+#include "shape/Renderable.h"
+#include "shape/Texture.h"
+#include "util/GLState.h"
+#include "util/ShaderStore.h"
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+// storage-block bindings of cull.comp.glsl (0 is the vertex shaders' Draws)
+constexpr GLuint kCommandsBinding = 1;
+constexpr GLuint kBoundsBinding = 2;
+constexpr GLuint kVisibleBinding = 3;
+constexpr GLuint kCountsBinding = 4;
+constexpr GLuint kCullGroupSize = 64; // local_size_x
+
+} // namespace
+
+StaticBatch::~StaticBatch() {
+  glDeleteBuffers(1, &commandBuffer);
+  glDeleteBuffers(1, &drawBuffer);
+  glDeleteBuffers(1, &boundsBuffer);
+  glDeleteBuffers(1, &visibleBuffer);
+  glDeleteBuffers(1, &countBuffer);
+}
+
+bool StaticBatch::supported() {
+  // the loader is generated for 3.3: the 4.3 entry points are only filled in
+  // when the driver lists the extensions that carry them
+  const bool gl43 =
+      GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+  return gl43 && GLAD_GL_ARB_multi_draw_indirect &&
+         GLAD_GL_ARB_shader_storage_buffer_object;
+}
+
+bool StaticBatch::cullingSupported() {
+  // glDispatchCompute, glClearBufferSubData and glMemoryBarrier
+  return supported() && GLAD_GL_ARB_compute_shader &&
+         GLAD_GL_ARB_clear_buffer_object &&
+         GLAD_GL_ARB_shader_image_load_store;
+}
+
+bool StaticBatch::covers(const Renderable *shape) const {
+  return std::binary_search(taken.begin(), taken.end(), shape);
+}
+
+void StaticBatch::build(const std::vector<Renderable *> &shapes) {
+  taken.clear();
+  runs.clear();
+  triangleCount = 0;
+  sourceCount = shapes.size();
+
+  // 1. every draw of every shape that can go in whole
+  std::vector<StaticDraw> draws;
+  for (Renderable *r : shapes) {
+    const std::size_t mark = draws.size();
+    auto *s = dynamic_cast<const StaticShape *>(r);
+    const bool ok =
+        s && s->collect(draws) &&
+        draws.size() <= GeometryArena::kMaxDrawIndex &&
+        std::all_of(draws.begin() + mark, draws.end(),
+                    [](const StaticDraw &d) {
+                      return ShaderStore::inst().indirect(d.shader) != nullptr;
+                    });
+    if (!ok) {
+      draws.erase(draws.begin() + mark, draws.end());
+      continue;
+    }
+    taken.push_back(r);
+  }
+  std::sort(taken.begin(), taken.end());
+
+  // 2. grouped by program, page and texture: each group is one call
+  std::vector<std::size_t> order(draws.size());
+  std::iota(order.begin(), order.end(), 0);
+  auto state = [&](std::size_t i) {
+    const StaticDraw &d = draws[i];
+    return std::make_tuple(d.shader, d.vao, d.texture.get());
+  };
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return state(a) < state(b);
+                   });
+
+  std::vector<Command> commands;
+  std::vector<glm::mat4> models;
+  std::vector<DrawBounds> bounds;
+  commands.reserve(draws.size());
+  models.reserve(draws.size());
+  bounds.reserve(draws.size());
+  for (std::size_t i : order) {
+    const StaticDraw &d = draws[i];
+    const GLuint index = GLuint(commands.size());
+    if (runs.empty() || state(i) != state(order[index - 1]))
+      runs.push_back({ShaderStore::inst().indirect(d.shader), d.vao,
+                      d.texture, GLsizei(index), 0});
+    ++runs.back().count;
+    commands.push_back({GLuint(d.count), 1, d.firstIndex, d.baseVertex,
+                        index});
+    models.push_back(d.model);
+    bounds.push_back({glm::vec4(d.bounds.min, 0.f),
+                      glm::vec4(d.bounds.max, 0.f), GLuint(runs.size() - 1),
+                      GLuint(runs.back().first), {0, 0}});
+    triangleCount += d.count / 3;
+  }
+  commandCount = GLsizei(commands.size());
+
+  if (!commandBuffer) {
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &drawBuffer);
+    glGenBuffers(1, &boundsBuffer);
+    glGenBuffers(1, &visibleBuffer);
+    glGenBuffers(1, &countBuffer);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER,
+               GLsizeiptr(commands.size() * sizeof(Command)), commands.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(models.size() * sizeof(glm::mat4)), models.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(bounds.size() * sizeof(DrawBounds)), bounds.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  // the culled lists' layout follows the commands: sized anew on first use
+  slots = slotCapacity = 0;
+}
+
+void StaticBatch::submit(DrawListStats &stats) const {
+  if (runs.empty())
+    return;
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+  drawRuns(stats, 0, nullptr);
+  stats.triangles += triangleCount;
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void StaticBatch::beginFrame() {
+  slots = 0;
+  if (!slotCapacity)
+    return;
+  // fresh storage, so this frame's passes don't wait on last frame's draws
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(slotCapacity) * commandCount * sizeof(Command),
+               nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(slotCapacity * runs.size() * sizeof(GLuint)),
+               nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void StaticBatch::reserveSlots(int n) {
+  if (n <= slotCapacity)
+    return;
+  slotCapacity = std::max(n, std::max(4, slotCapacity * 2));
+  // earlier slots' draws are already issued: they keep the old storage
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(slotCapacity) * commandCount * sizeof(Command),
+               nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               GLsizeiptr(slotCapacity * runs.size() * sizeof(GLuint)),
+               nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void StaticBatch::submitCulled(DrawListStats &stats, const glm::vec2 &lo,
+                               const glm::vec2 &hi) {
+  if (runs.empty())
+    return;
+  reserveSlots(slots + 1);
+  const int slot = slots++;
+  const GLintptr visible =
+      GLintptr(slot) * commandCount * GLintptr(sizeof(Command));
+  const GLintptr counts = GLintptr(slot * runs.size() * sizeof(GLuint));
+  const bool gpuCount = GLAD_GL_ARB_indirect_parameters;
+
+  // 1. zero the run counters - and, when the draws can't read them, the
+  //    commands the pass leaves unwritten, so they draw nothing
+  const GLuint zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, counts,
+                       GLsizeiptr(runs.size() * sizeof(GLuint)),
+                       GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  if (!gpuCount) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, visible,
+                         GLsizeiptr(commandCount) * sizeof(Command),
+                         GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  // 2. one invocation per draw against the bound Camera block
+  Shader *cull = ShaderStore::inst().cull();
+  static const auto uRegion = cull->uniform<glm::vec4>("region");
+  static const auto uDrawCount = cull->uniform<GLint>("drawCount");
+  static const auto uOutBase = cull->uniform<GLint>("outBase");
+  static const auto uCountBase = cull->uniform<GLint>("countBase");
+  cull->use();
+  cull->set(uRegion, glm::vec4(lo.x, lo.y, hi.x, hi.y));
+  cull->set(uDrawCount, GLint(commandCount));
+  cull->set(uOutBase, GLint(slot * commandCount));
+  cull->set(uCountBase, GLint(slot * runs.size()));
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandsBinding, commandBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kBoundsBinding, boundsBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibleBinding, visibleBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCountsBinding, countBuffer);
+  const GLuint groups =
+      (GLuint(commandCount) + kCullGroupSize - 1) / kCullGroupSize;
+  glDispatchCompute(groups, 1, 1);
+  // the draws read what the pass wrote as indirect commands and counts
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+  // 3. the survivors
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, visibleBuffer);
+  if (gpuCount) {
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, countBuffer);
+    drawRuns(stats, visible, &counts);
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+  } else {
+    drawRuns(stats, visible, nullptr);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  // the number that passed stays on the GPU: count every candidate
+  stats.gpuCulled += commandCount;
+  stats.triangles += triangleCount;
+}
+
+void StaticBatch::drawRuns(DrawListStats &stats, GLintptr commands,
+                           const GLintptr *counts) const {
+  GLState &gl = GLState::inst();
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kDrawsBinding, drawBuffer);
+  gl.activeTexture(GL_TEXTURE0);
+
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    const Run &r = runs[i];
+    r.program->use();
+    ++stats.programs;
+    if (r.texture) {
+      // looked up every time: a streamed texture changes handle once loaded
+      gl.bindTexture(GL_TEXTURE_2D, r.texture->handle());
+      ++stats.textures;
+    }
+    gl.bindVertexArray(r.vao);
+    ++stats.vaos;
+    const void *first =
+        (void *)(commands + GLintptr(r.first) * GLintptr(sizeof(Command)));
+    if (counts)
+      glMultiDrawElementsIndirectCountARB(
+          GL_TRIANGLES, GL_UNSIGNED_INT, first,
+          *counts + GLintptr(i * sizeof(GLuint)), r.count, 0);
+    else
+      glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, first,
+                                  r.count, 0);
+    ++stats.multiDraws;
+    stats.batchedDraws += r.count;
+  }
+}
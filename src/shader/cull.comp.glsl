@@ -0,0 +1,79 @@
+#version 430 core
+// StaticBatch culling: one invocation per draw. A draw whose bounds touch
+// the view is appended to its run's part of this view's command list.
+layout(local_size_x = 64) in;
+
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+struct Command { // DrawElementsIndirectCommand
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int  baseVertex;
+    uint baseInstance;
+};
+
+struct DrawBounds {
+    vec4  lo;  // world space; lo.x > hi.x: empty, never culled
+    vec4  hi;
+    uvec4 run; // x: the draw's run, y: the run's first command
+};
+
+layout(std430, binding = 1) readonly buffer Commands {
+    Command commands[];
+};
+layout(std430, binding = 2) readonly buffer Bounds {
+    DrawBounds bounds[];
+};
+layout(std430, binding = 3) writeonly buffer Visible {
+    Command visible[];
+};
+layout(std430, binding = 4) buffer Counts {
+    uint counts[];
+};
+
+uniform vec4 region;  // on-screen part of the view, NDC: lo.xy, hi.xy
+uniform int drawCount;
+uniform int outBase;   // this view's first command in Visible
+uniform int countBase; // ... and first counter in Counts
+
+// the box wholly behind <p>; planes aren't normalised, both sides scale
+bool outside(vec4 p, vec3 c, vec3 e)
+{
+    return dot(p.xyz, c) + p.w + dot(abs(p.xyz), e) < 0.0;
+}
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(drawCount))
+        return;
+
+    DrawBounds b = bounds[i];
+    if (b.lo.x <= b.hi.x) {
+        vec3 c = (b.lo.xyz + b.hi.xyz) * 0.5;
+        vec3 e = (b.hi.xyz - b.lo.xyz) * 0.5;
+        // rows of viewProj, as in Frustum (a stencil view's oblique near
+        // plane included)
+        mat4 R = transpose(uViewProj);
+        if (outside(R[0] - region.x * R[3], c, e) ||
+            outside(region.z * R[3] - R[0], c, e) ||
+            outside(R[1] - region.y * R[3], c, e) ||
+            outside(region.w * R[3] - R[1], c, e) ||
+            outside(R[3] + R[2], c, e) ||
+            outside(R[3] - R[2], c, e) ||
+            // behind the portal an FBO view looks out of (0 at the root and
+            // in stencil views, whose projection is oblique already)
+            outside(uClipPlane, c, e))
+            return;
+    }
+
+    uint slot = atomicAdd(counts[countBase + int(b.run.x)], 1u);
+    visible[outBase + int(b.run.y + slot)] = commands[i];
+}
@@ -0,0 +1,9 @@
+#version 330 core
+in vec2 vUV;
+flat in float vLayer;
+out vec4 FragColor;
+
+uniform sampler2DArray tex0;
+void main() {
+    FragColor = texture(tex0, vec3(vUV, vLayer));
+}
@@ -0,0 +1,26 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aUV;
+
+// per instance (mat4 takes locations 2..5)
+layout(location = 2) in mat4 iModel;
+layout(location = 6) in float iLayer;
+
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+out vec2 vUV;
+flat out float vLayer;
+
+void main()
+{
+    gl_Position = uViewProj * iModel * vec4(aPos, 1.0);
+
+    vUV    = aUV;
+    vLayer = iLayer;
+}
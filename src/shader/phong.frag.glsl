@@ -4,7 +4,13 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 
-uniform vec3 viewPos;
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
 uniform vec3 lightPos = vec3(3.0,3.0,3.0);
 uniform vec3 lightColor = vec3(1.0);
 
@@ -17,7 +23,7 @@ void main()
     float diff = max(dot(norm, lightDir), 0.0);
 
     // specular
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(uEye.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
 
@@ -3,7 +3,15 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTex;
 
-uniform mat4 model, view, proj;
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+uniform mat4 model;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -15,5 +23,5 @@ void main()
     FragPos       = worldPos.xyz;
     Normal        = mat3(transpose(inverse(model))) * aNormal;
 
-    gl_Position        = proj * view * worldPos;
+    gl_Position        = uViewProj * worldPos;
 }
@@ -0,0 +1,32 @@
+#version 430 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTex;
+// the draw's index in its StaticBatch (the command's baseInstance)
+layout(location = 7) in uint aDraw;
+
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+layout(std430, binding = 0) readonly buffer Draws {
+    mat4 models[];
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+
+void main()
+{
+    mat4 model    = models[aDraw];
+    vec4 worldPos = model * vec4(aPos,1.0);
+
+    FragPos       = worldPos.xyz;
+    Normal        = mat3(transpose(inverse(model))) * aNormal;
+
+    gl_Position        = uViewProj * worldPos;
+}
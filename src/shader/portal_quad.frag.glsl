@@ -4,7 +4,35 @@ in vec2 vUV; // <-- flat UVs from vertex shader
 uniform sampler2D portalTex;
 out vec4 FragColor;
 
+// temporal reuse: portalTex was rendered on an earlier frame
+uniform bool uReproject = false;
+uniform sampler2D portalDepth;
+uniform mat4 uHistoryInvVP; // inverse VP portalTex was rendered with
+uniform mat4 uCurrentVP;    // VP a fresh render would use
+
+// view skipped by the frame budget with nothing to fall back on
+uniform bool uFill = false;
+uniform vec4 uFillColor = vec4(0.05, 0.05, 0.08, 1.0);
+
 void main()
 {
-    FragColor = texture(portalTex, vUV);
+    if (uFill) {
+        FragColor = uFillColor;
+        return;
+    }
+
+    vec2 uv = vUV;
+
+    if (uReproject) {
+        // point the old view saw here, and where the new view sees it ...
+        float d = texture(portalDepth, uv).r;
+        vec4 world = uHistoryInvVP * vec4(uv * 2.0 - 1.0, d * 2.0 - 1.0, 1.0);
+        vec4 clip = uCurrentVP * vec4(world.xyz / world.w, 1.0);
+        vec2 moved = clip.xy / clip.w * 0.5 + 0.5;
+
+        // ... so step back by that motion (one fixed-point iteration)
+        uv = clamp(uv - (moved - uv), 0.0, 1.0);
+    }
+
+    FragColor = texture(portalTex, uv);
 }
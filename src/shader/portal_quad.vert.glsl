@@ -2,16 +2,23 @@
 #version 330 core
 layout(location=0) in vec3 aPos;
 
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
 uniform mat4 uModel;      // portal’s model → world
-uniform mat4 uPortalVP;   // Pdst * Vdst, passed in C++
-uniform mat4 uView, uProj;
+uniform mat4 uPortalVP;   // PortalQuad::portalVP: quad-local → texture clip
 
 out vec2 vUV;
 
 void main() {
     // draw the portal frame
     vec4 worldPos = uModel * vec4(aPos,1.0);
-    gl_Position   = uProj * uView * worldPos;
+    gl_Position   = uViewProj * worldPos;
 
     // project into the portal‐camera’s clip space
     vec4 clipPos = uPortalVP * vec4(aPos,1.0);
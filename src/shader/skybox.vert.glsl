@@ -0,0 +1,21 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+out vec3 vDir;
+
+void main()
+{
+    // rotation only: the cube stays centred on the eye
+    vec4 clip   = uProj * vec4(mat3(uView) * aPos, 1.0);
+    gl_Position = clip.xyww; // z/w == 1: the far plane, behind everything
+
+    vDir = aPos;
+}
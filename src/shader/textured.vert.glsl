@@ -2,14 +2,22 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aUV;
 
-uniform mat4 model, view, proj;
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+uniform mat4 model;
 
 out vec2 vUV;
 
 void main()
 {
     vec4 worldPos      = model * vec4(aPos, 1.0);
-    gl_Position        = proj * view * worldPos;
+    gl_Position        = uViewProj * worldPos;
 
     vUV = aUV;
 }
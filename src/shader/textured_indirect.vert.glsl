@@ -0,0 +1,27 @@
+#version 430 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aUV;
+// the draw's index in its StaticBatch (the command's baseInstance)
+layout(location = 7) in uint aDraw;
+
+layout(std140) uniform Camera {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uEye;
+    vec4 uClipPlane;
+};
+
+layout(std430, binding = 0) readonly buffer Draws {
+    mat4 models[];
+};
+
+out vec2 vUV;
+
+void main()
+{
+    vec4 worldPos      = models[aDraw] * vec4(aPos, 1.0);
+    gl_Position        = uViewProj * worldPos;
+
+    vUV = aUV;
+}
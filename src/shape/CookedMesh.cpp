@@ -0,0 +1,129 @@
+#include "shape/CookedMesh.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+static_assert(sizeof(Vertex) % 4 == 0 && sizeof(unsigned) == 4,
+              "cooked sections must stay 4-byte aligned");
+
+// size + mtime of the source; both 0 when it can't be read
+static void sourceStamp(const std::string &source, std::uint64_t &size,
+                        std::int64_t &time) {
+  std::error_code ec;
+  size = fs::file_size(source, ec);
+  auto t = fs::last_write_time(source, ec);
+  if (ec) {
+    size = 0;
+    time = 0;
+    return;
+  }
+  time = std::int64_t(t.time_since_epoch().count());
+}
+
+static void toFloats(const glm::vec3 &v, float out[3]) {
+  out[0] = v.x;
+  out[1] = v.y;
+  out[2] = v.z;
+}
+
+bool CookedMesh::write(const std::string &source, const MeshData &data,
+                       unsigned importFlags) {
+  Header h{};
+  h.magic = kMagic;
+  h.version = kVersion;
+  h.importFlags = importFlags;
+  h.vertexSize = sizeof(Vertex);
+  sourceStamp(source, h.sourceSize, h.sourceTime);
+  h.submeshCount = std::uint32_t(data.submeshes.size());
+  h.vertexCount = std::uint32_t(data.vertices.size());
+  h.indexCount = std::uint32_t(data.indices.size());
+  toFloats(data.bounds.min, h.min);
+  toFloats(data.bounds.max, h.max);
+
+  std::ofstream out(pathFor(source), std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  for (const MeshData::Submesh &s : data.submeshes) {
+    SubmeshRecord r{s.firstVertex, s.vertexCount, s.firstIndex, s.indexCount,
+                    {}, {}, {}};
+    std::copy(std::begin(s.lodIndexCount), std::end(s.lodIndexCount),
+              r.lodIndexCount);
+    toFloats(s.bounds.min, r.min);
+    toFloats(s.bounds.max, r.max);
+    out.write(reinterpret_cast<const char *>(&r), sizeof(r));
+  }
+  out.write(reinterpret_cast<const char *>(data.vertices.data()),
+            std::streamsize(data.vertices.size() * sizeof(Vertex)));
+  out.write(reinterpret_cast<const char *>(data.indices.data()),
+            std::streamsize(data.indices.size() * sizeof(unsigned)));
+  return bool(out);
+}
+
+CookedMesh::CookedMesh(const std::string &source, unsigned importFlags)
+    : file(pathFor(source)) {
+  if (!file || file.size() < sizeof(Header))
+    return;
+  const auto *h = reinterpret_cast<const Header *>(file.data());
+  if (h->magic != kMagic || h->version != kVersion ||
+      h->importFlags != importFlags || h->vertexSize != sizeof(Vertex))
+    return;
+
+  // stale if the source changed since it was cooked (a cooked file shipped
+  // without its source is used as is)
+  std::uint64_t size;
+  std::int64_t time;
+  sourceStamp(source, size, time);
+  if (size && (size != h->sourceSize || time != h->sourceTime))
+    return;
+
+  const std::size_t subBytes = h->submeshCount * sizeof(SubmeshRecord);
+  const std::size_t vertBytes = std::size_t(h->vertexCount) * sizeof(Vertex);
+  const std::size_t idxBytes = std::size_t(h->indexCount) * sizeof(unsigned);
+  if (file.size() != sizeof(Header) + subBytes + vertBytes + idxBytes)
+    return;
+
+  const unsigned char *p = file.data() + sizeof(Header);
+  subs = reinterpret_cast<const SubmeshRecord *>(p);
+  verts = reinterpret_cast<const Vertex *>(p + subBytes);
+  idx = reinterpret_cast<const unsigned *>(p + subBytes + vertBytes);
+  for (std::uint32_t i = 0; i < h->submeshCount; ++i) {
+    const SubmeshRecord &s = subs[i];
+    if (std::uint64_t(s.firstVertex) + s.vertexCount > h->vertexCount ||
+        std::uint64_t(s.firstIndex) + s.indexCount > h->indexCount)
+      return;
+    // the levels must tile the submesh's index range exactly
+    std::uint64_t lodTotal = 0;
+    for (std::uint32_t n : s.lodIndexCount)
+      lodTotal += n;
+    if (s.lodIndexCount[0] == 0 || lodTotal != s.indexCount)
+      return;
+  }
+
+  file.adviseSequential();
+  hdr = h;
+}
+
+MeshData::Submesh CookedMesh::submesh(std::uint32_t i) const {
+  const SubmeshRecord &r = subs[i];
+  MeshData::Submesh s;
+  s.firstVertex = r.firstVertex;
+  s.vertexCount = r.vertexCount;
+  s.firstIndex = r.firstIndex;
+  s.indexCount = r.indexCount;
+  std::copy(std::begin(r.lodIndexCount), std::end(r.lodIndexCount),
+            s.lodIndexCount);
+  s.bounds.min = glm::vec3(r.min[0], r.min[1], r.min[2]);
+  s.bounds.max = glm::vec3(r.max[0], r.max[1], r.max[2]);
+  return s;
+}
+
+Bounds CookedMesh::bounds() const {
+  Bounds b;
+  b.min = glm::vec3(hdr->min[0], hdr->min[1], hdr->min[2]);
+  b.max = glm::vec3(hdr->max[0], hdr->max[1], hdr->max[2]);
+  return b;
+}
@@ -0,0 +1,165 @@
+#include "shape/DdsImage.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::uint32_t fourCC(char a, char b, char c, char d) {
+  return std::uint32_t(std::uint8_t(a)) | std::uint32_t(std::uint8_t(b)) << 8 |
+         std::uint32_t(std::uint8_t(c)) << 16 |
+         std::uint32_t(std::uint8_t(d)) << 24;
+}
+
+constexpr std::uint32_t kMagic = fourCC('D', 'D', 'S', ' ');
+
+// DDS_HEADER / DDS_PIXELFORMAT / DDS_HEADER_DXT10 as documented by Microsoft
+struct PixelFormat {
+  std::uint32_t size, flags, fourCC, rgbBitCount;
+  std::uint32_t rMask, gMask, bMask, aMask;
+};
+struct Header {
+  std::uint32_t size, flags, height, width, pitchOrLinearSize, depth;
+  std::uint32_t mipMapCount, reserved1[11];
+  PixelFormat pf;
+  std::uint32_t caps, caps2, caps3, caps4, reserved2;
+};
+struct HeaderDX10 {
+  std::uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize,
+      miscFlags2;
+};
+static_assert(sizeof(Header) == 124 && sizeof(HeaderDX10) == 20,
+              "DDS headers must match the file layout");
+
+constexpr std::uint32_t kFlagCaps = 0x1, kFlagHeight = 0x2, kFlagWidth = 0x4,
+                        kFlagPixelFormat = 0x1000, kFlagMipMapCount = 0x20000,
+                        kFlagLinearSize = 0x80000;
+constexpr std::uint32_t kPfFourCC = 0x4;
+constexpr std::uint32_t kCapsComplex = 0x8, kCapsTexture = 0x1000,
+                        kCapsMipMap = 0x400000;
+constexpr std::uint32_t kDxgiBC1 = 71, kDxgiBC1Srgb = 72, kDxgiBC3 = 77,
+                        kDxgiBC3Srgb = 78, kDxgiBC7 = 98, kDxgiBC7Srgb = 99;
+constexpr std::uint32_t kDimensionTexture2D = 3;
+
+} // namespace
+
+bool DdsImage::isFresh(const std::string &source) {
+  std::error_code ec;
+  auto dds = fs::last_write_time(pathFor(source), ec);
+  if (ec)
+    return false;
+  // a compressed file shipped without its source is used as is
+  auto src = fs::last_write_time(source, ec);
+  return ec || dds >= src;
+}
+
+bool DdsImage::write(const std::string &path, Format f, int width, int height,
+                     const std::vector<std::vector<unsigned char>> &levels) {
+  Header h{};
+  h.size = sizeof(Header);
+  h.flags = kFlagCaps | kFlagHeight | kFlagWidth | kFlagPixelFormat |
+            kFlagMipMapCount | kFlagLinearSize;
+  h.height = std::uint32_t(height);
+  h.width = std::uint32_t(width);
+  h.pitchOrLinearSize = std::uint32_t(levelBytes(f, width, height));
+  h.mipMapCount = std::uint32_t(levels.size());
+  h.pf.size = sizeof(PixelFormat);
+  h.pf.flags = kPfFourCC;
+  h.caps = kCapsTexture | (levels.size() > 1 ? kCapsComplex | kCapsMipMap : 0);
+
+  // BC7 has no legacy FourCC; it needs the DX10 extension header
+  HeaderDX10 dx10{kDxgiBC7, kDimensionTexture2D, 0, 1, 0};
+  switch (f) {
+  case Format::BC1:
+    h.pf.fourCC = fourCC('D', 'X', 'T', '1');
+    break;
+  case Format::BC3:
+    h.pf.fourCC = fourCC('D', 'X', 'T', '5');
+    break;
+  case Format::BC7:
+    h.pf.fourCC = fourCC('D', 'X', '1', '0');
+    break;
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+  out.write(reinterpret_cast<const char *>(&kMagic), sizeof(kMagic));
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  if (f == Format::BC7)
+    out.write(reinterpret_cast<const char *>(&dx10), sizeof(dx10));
+  for (const auto &l : levels)
+    out.write(reinterpret_cast<const char *>(l.data()),
+              std::streamsize(l.size()));
+  return bool(out);
+}
+
+DdsImage::DdsImage(const std::string &path) : file(path) {
+  std::size_t offset = sizeof(kMagic) + sizeof(Header);
+  if (!file || file.size() < offset)
+    return;
+  std::uint32_t magic;
+  std::memcpy(&magic, file.data(), sizeof(magic));
+  const auto *h = reinterpret_cast<const Header *>(file.data() + 4);
+  if (magic != kMagic || h->size != sizeof(Header) ||
+      !(h->pf.flags & kPfFourCC) || h->width == 0 || h->height == 0)
+    return;
+
+  // volume textures, cube maps and arrays are not 2D textures
+  if (h->caps2 != 0)
+    return;
+
+  if (h->pf.fourCC == fourCC('D', 'X', 'T', '1')) {
+    fmt = Format::BC1;
+  } else if (h->pf.fourCC == fourCC('D', 'X', 'T', '5')) {
+    fmt = Format::BC3;
+  } else if (h->pf.fourCC == fourCC('D', 'X', '1', '0')) {
+    if (file.size() < offset + sizeof(HeaderDX10))
+      return;
+    const auto *dx10 =
+        reinterpret_cast<const HeaderDX10 *>(file.data() + offset);
+    offset += sizeof(HeaderDX10);
+    if (dx10->resourceDimension != kDimensionTexture2D || dx10->arraySize > 1)
+      return;
+    switch (dx10->dxgiFormat) {
+    case kDxgiBC1:
+    case kDxgiBC1Srgb:
+      fmt = Format::BC1;
+      break;
+    case kDxgiBC3:
+    case kDxgiBC3Srgb:
+      fmt = Format::BC3;
+      break;
+    case kDxgiBC7:
+    case kDxgiBC7Srgb:
+      fmt = Format::BC7;
+      break;
+    default:
+      return;
+    }
+  } else {
+    return;
+  }
+
+  const int count = (h->flags & kFlagMipMapCount)
+                        ? std::max<int>(1, int(h->mipMapCount))
+                        : 1;
+  int w = int(h->width), ht = int(h->height);
+  std::vector<Level> parsed;
+  for (int i = 0; i < count; ++i) {
+    const std::size_t size = levelBytes(fmt, w, ht);
+    if (offset + size > file.size())
+      return;
+    parsed.push_back({w, ht, file.data() + offset, size});
+    offset += size;
+    if (w == 1 && ht == 1)
+      break;
+    w = std::max(1, w / 2);
+    ht = std::max(1, ht / 2);
+  }
+  levels = std::move(parsed);
+}
@@ -1,11 +1,12 @@
 /// STOP. You should not modify this file unless you KNOW what you are doing.
 
 #include "shape/GLShape.h"
+#include "util/GLState.h"
 
 
 GLShape::~GLShape() noexcept
 {
-    glDeleteVertexArrays(1, &vao);
+    GLState::inst().deleteVertexArrays(1, &vao);
     vao = 0U;
 
     glDeleteBuffers(1, &vbo);
@@ -13,10 +14,18 @@ GLShape::~GLShape() noexcept
 }
 
 
-GLShape::GLShape(Shader * shader) : pShader(shader)
+GLShape::GLShape(Shader * shader) : GLShape(shader, true)
 {
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
+}
+
+
+GLShape::GLShape(Shader * shader, bool ownBuffers) : pShader(shader)
+{
+    if (ownBuffers)
+    {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+    }
 }
 
 
@@ -0,0 +1,136 @@
+#include "shape/InstancedBoxes.h"
+#include "render/DrawList.h"
+#include "util/GLState.h"
+#include "util/Shader.h"
+#include <array>
+#include <cstddef>
+
+struct BoxVertex {
+  glm::vec3 pos;
+  glm::vec2 uv;
+};
+
+// 6 faces × 2 triangles, each face mapped to the full [0,1]² of its layer
+static std::array<BoxVertex, 36> buildBox(const glm::vec3 &h) {
+  // corner order per face: bottom-left, bottom-right, top-right, top-left
+  const glm::vec3 faces[6][4] = {
+      {{+h.x, -h.y, +h.z}, {+h.x, -h.y, -h.z},
+       {+h.x, +h.y, -h.z}, {+h.x, +h.y, +h.z}}, // +X
+      {{-h.x, -h.y, -h.z}, {-h.x, -h.y, +h.z},
+       {-h.x, +h.y, +h.z}, {-h.x, +h.y, -h.z}}, // -X
+      {{-h.x, +h.y, +h.z}, {+h.x, +h.y, +h.z},
+       {+h.x, +h.y, -h.z}, {-h.x, +h.y, -h.z}}, // +Y
+      {{-h.x, -h.y, -h.z}, {+h.x, -h.y, -h.z},
+       {+h.x, -h.y, +h.z}, {-h.x, -h.y, +h.z}}, // -Y
+      {{-h.x, -h.y, +h.z}, {+h.x, -h.y, +h.z},
+       {+h.x, +h.y, +h.z}, {-h.x, +h.y, +h.z}}, // +Z
+      {{+h.x, -h.y, -h.z}, {-h.x, -h.y, -h.z},
+       {-h.x, +h.y, -h.z}, {+h.x, +h.y, -h.z}}}; // -Z
+  const glm::vec2 uv[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  const int tri[6] = {0, 1, 2, 0, 2, 3};
+
+  std::array<BoxVertex, 36> v;
+  for (int f = 0; f < 6; ++f)
+    for (int k = 0; k < 6; ++k)
+      v[f * 6 + k] = {faces[f][tri[k]], uv[tri[k]]};
+  return v;
+}
+
+InstancedBoxes::InstancedBoxes(Shader *sh, const glm::vec3 &size,
+                               std::shared_ptr<Texture2DArray> tex)
+    : GLShape(sh), textures(std::move(tex)) {
+  glm::vec3 half = size * 0.5f;
+  boxBounds.expand(-half);
+  boxBounds.expand(half);
+  auto v = buildBox(half);
+
+  glGenBuffers(1, &instanceVbo);
+
+  GLState::inst().bindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(v), v.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BoxVertex),
+                        (void *)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BoxVertex),
+                        (void *)offsetof(BoxVertex, uv));
+  glEnableVertexAttribArray(1);
+
+  // per-instance: model matrix as four vec4 columns, then the layer
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+  for (int c = 0; c < 4; ++c) {
+    glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          (void *)(offsetof(Instance, model) +
+                                   c * sizeof(glm::vec4)));
+    glEnableVertexAttribArray(2 + c);
+    glVertexAttribDivisor(2 + c, 1);
+  }
+  glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                        (void *)offsetof(Instance, layer));
+  glEnableVertexAttribArray(6);
+  glVertexAttribDivisor(6, 1);
+
+  GLState::inst().bindVertexArray(0);
+
+  uTex0 = sh->uniform<GLint>("tex0");
+}
+
+InstancedBoxes::~InstancedBoxes() noexcept {
+  glDeleteBuffers(1, &instanceVbo);
+}
+
+int InstancedBoxes::add(const glm::mat4 &model, int layer) {
+  instances.push_back({model, float(layer)});
+  dirty = boundsDirty = true;
+  touch();
+  return int(instances.size()) - 1;
+}
+
+void InstancedBoxes::upload() {
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+  if (instances.size() > capacity)
+    capacity = instances.capacity();
+  // orphan: the driver hands us fresh storage while earlier views of this
+  // frame may still be reading the old transforms
+  glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr,
+               GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance),
+                  instances.data());
+  dirty = false;
+}
+
+void InstancedBoxes::render() {
+  if (instances.empty())
+    return;
+  if (dirty)
+    upload();
+
+  pShader->use();
+  textures->bind(0);
+
+  GLState::inst().bindVertexArray(vao);
+  drawPart(0);
+}
+
+void InstancedBoxes::emit(DrawList &list) {
+  if (!instances.empty())
+    list.add(pShader, GL_TEXTURE_2D_ARRAY, textures->handle(), vao, this, 0,
+             bounds());
+}
+
+void InstancedBoxes::drawPart(int) {
+  if (dirty)
+    upload();
+  pShader->set(uTex0, 0);
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 36, GLsizei(instances.size()));
+}
+
+Bounds InstancedBoxes::bounds() const {
+  if (boundsDirty) {
+    cachedBounds = {};
+    for (const Instance &in : instances)
+      cachedBounds.expand(boxBounds.transformed(in.model));
+    boundsDirty = false;
+  }
+  return cachedBounds;
+}
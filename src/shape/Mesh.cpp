@@ -1,36 +1,49 @@
 #include "shape/Mesh.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 
-Mesh::Mesh(Shader *sh, std::vector<Vertex> v, std::vector<unsigned> i)
-    : GLShape(sh), verts(std::move(v)), idx(std::move(i)) {
-  glBindVertexArray(vao);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), verts.data(),
-               GL_STATIC_DRAW);
+Mesh::Mesh(Shader *sh, std::vector<Vertex> v, std::vector<unsigned> i,
+           Residency residency)
+    : GLShape(sh, false) {
+  for (const Vertex &vx : v)
+    localBounds.expand(vx.pos);
+  upload(v.data(), v.size(), i.data(), i.size());
+  if (residency == Residency::CpuCopy) {
+    verts = std::move(v);
+    idx = std::move(i);
+  }
+}
 
-  GLuint ebo;
-  glGenBuffers(1, &ebo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned),
-               idx.data(), GL_STATIC_DRAW);
+Mesh::Mesh(Shader *sh, const Vertex *v, std::size_t nv, const unsigned *i,
+           std::size_t ni, const Bounds &bounds, std::vector<Lod> levels,
+           Residency residency)
+    : GLShape(sh, false), localBounds(bounds), lods(std::move(levels)) {
+  upload(v, nv, i, ni);
+  if (residency == Residency::CpuCopy) {
+    verts.assign(v, v + nv);
+    idx.assign(i, i + ni);
+  }
+}
 
-  // layout
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, normal));
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, tex));
-  glEnableVertexAttribArray(2);
+static_assert(sizeof(Vertex) == 8 * sizeof(float),
+              "Vertex must match VertexFormat::P3N3T2");
 
-  glBindVertexArray(0);
+void Mesh::upload(const Vertex *v, std::size_t nv, const unsigned *i,
+                  std::size_t ni) {
+  if (lods.empty())
+    lods.push_back({0, GLsizei(ni)});
+  geometry = GeometryArena::inst().allocate(VertexFormat::P3N3T2, v, nv, i,
+                                            ni);
 }
 
 void Mesh::render() {
-  pShader->use();
-  glBindVertexArray(vao);
-  glDrawElements(GL_TRIANGLES, idx.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  if (pShader) // shared meshes are drawn with their owner's program
+    pShader->use();
+  GLState::inst().bindVertexArray(geometry.vertexArray());
+  draw();
+}
+
+void Mesh::draw(int lod) const {
+  const Lod &l = level(lod);
+  geometry.draw(l.count, l.first);
 }
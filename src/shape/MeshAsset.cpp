@@ -0,0 +1,62 @@
+#include "shape/MeshAsset.h"
+#include "shape/CookedMesh.h"
+#include <algorithm>
+#include <chrono>
+
+// the submesh's levels of detail as ranges of its own slice of the indices
+static std::vector<Mesh::Lod> lodsOf(const MeshData::Submesh &s) {
+  std::vector<Mesh::Lod> lods;
+  GLsizei first = 0;
+  for (int l = 0; l < s.lodCount(); ++l) {
+    lods.push_back({first, GLsizei(s.lodIndexCount[l])});
+    first += GLsizei(s.lodIndexCount[l]);
+  }
+  return lods;
+}
+
+MeshAsset::MeshAsset(const std::string &path, unsigned importFlags,
+                     Mesh::Residency residency)
+    : keep(residency) {
+  auto t0 = std::chrono::steady_clock::now();
+
+  if (CookedMesh cooked{path, importFlags}) {
+    for (std::uint32_t i = 0; i < cooked.submeshCount(); ++i) {
+      MeshData::Submesh s = cooked.submesh(i);
+      parts.emplace_back(std::make_unique<Mesh>(
+          nullptr, cooked.vertices() + s.firstVertex, s.vertexCount,
+          cooked.indices() + s.firstIndex, s.indexCount, s.bounds,
+          lodsOf(s), residency));
+    }
+    localBounds = cooked.bounds();
+    fromCooked = true;
+  } else {
+    MeshData data = MeshData::import(path, importFlags);
+    for (const MeshData::Submesh &s : data.submeshes)
+      parts.emplace_back(std::make_unique<Mesh>(
+          nullptr, data.vertices.data() + s.firstVertex, s.vertexCount,
+          data.indices.data() + s.firstIndex, s.indexCount, s.bounds,
+          lodsOf(s), residency));
+    localBounds = data.bounds;
+  }
+
+  for (const auto &m : parts)
+    levels = std::max(levels, m->lodCount());
+
+  ms = std::chrono::duration<double, std::milli>(
+           std::chrono::steady_clock::now() - t0)
+           .count();
+}
+
+std::size_t MeshAsset::cpuBytes() const {
+  std::size_t n = 0;
+  for (const auto &m : parts)
+    n += m->cpuBytes();
+  return n;
+}
+
+std::size_t MeshAsset::gpuBytes() const {
+  std::size_t n = 0;
+  for (const auto &m : parts)
+    n += m->gpuBytes();
+  return n;
+}
@@ -0,0 +1,110 @@
+#include "shape/MeshData.h"
+#include "shape/MeshSimplifier.h"
+#include "shape/ObjLoader.h"
+#include <algorithm>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <cctype>
+#include <stdexcept>
+
+static void flattenNode(const aiNode *node, const aiScene *scene,
+                        MeshData &out) {
+  for (unsigned i = 0; i < node->mNumMeshes; i++) {
+    const aiMesh *m = scene->mMeshes[node->mMeshes[i]];
+    MeshData::Submesh sub;
+    sub.firstVertex = std::uint32_t(out.vertices.size());
+    sub.vertexCount = m->mNumVertices;
+    sub.firstIndex = std::uint32_t(out.indices.size());
+
+    for (unsigned k = 0; k < m->mNumVertices; k++) {
+      Vertex v{};
+      v.pos = {m->mVertices[k].x, m->mVertices[k].y, m->mVertices[k].z};
+      v.normal = {m->mNormals[k].x, m->mNormals[k].y, m->mNormals[k].z};
+      if (m->mTextureCoords[0])
+        v.tex = {m->mTextureCoords[0][k].x, m->mTextureCoords[0][k].y};
+      sub.bounds.expand(v.pos);
+      out.vertices.push_back(v);
+    }
+    for (unsigned f = 0; f < m->mNumFaces; ++f) {
+      auto &face = m->mFaces[f];
+      out.indices.insert(out.indices.end(), face.mIndices,
+                         face.mIndices + face.mNumIndices);
+    }
+    sub.indexCount = std::uint32_t(out.indices.size()) - sub.firstIndex;
+
+    out.bounds.expand(sub.bounds);
+    out.submeshes.push_back(sub);
+  }
+  for (unsigned c = 0; c < node->mNumChildren; ++c)
+    flattenNode(node->mChildren[c], scene, out);
+}
+
+static bool isObj(const std::string &path) {
+  if (path.size() < 4)
+    return false;
+  std::string ext = path.substr(path.size() - 4);
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return char(std::tolower(c)); });
+  return ext == ".obj";
+}
+
+MeshData MeshData::import(const std::string &path, unsigned importFlags) {
+  MeshData out;
+  bool loaded = false;
+  // ObjLoader does what the default flags ask for (triangles, smooth
+  // normals where missing; there is no tangent in Vertex)
+  if (importFlags == kDefaultImport && isObj(path)) {
+    try {
+      out = ObjLoader::load(path);
+      loaded = true;
+    } catch (const std::runtime_error &) {
+      // let Assimp have a go (and report the error if it fails too)
+    }
+  }
+  if (!loaded)
+    out = importAssimp(path, importFlags);
+  out.buildLods();
+  return out;
+}
+
+MeshData MeshData::importAssimp(const std::string &path,
+                                unsigned importFlags) {
+  Assimp::Importer imp;
+  const aiScene *sc = imp.ReadFile(path, importFlags);
+  if (!sc || sc->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !sc->mRootNode)
+    throw std::runtime_error("Assimp: " + std::string(imp.GetErrorString()));
+
+  MeshData out;
+  flattenNode(sc->mRootNode, sc, out);
+  return out;
+}
+
+void MeshData::buildLods() {
+  std::vector<unsigned> out;
+  out.reserve(indices.size() * 2);
+
+  for (Submesh &s : submeshes) {
+    const unsigned *full = indices.data() + s.firstIndex;
+    const std::uint32_t first = std::uint32_t(out.size());
+    out.insert(out.end(), full, full + s.indexCount);
+    std::fill(std::begin(s.lodIndexCount), std::end(s.lodIndexCount), 0u);
+    s.lodIndexCount[0] = s.indexCount;
+
+    MeshSimplifier simplifier(vertices.data() + s.firstVertex, s.vertexCount,
+                              full, s.indexCount);
+    std::size_t prev = s.indexCount / 3;
+    for (int l = 1; l < kMaxLods && prev / 2 >= kMinLodTriangles; ++l) {
+      std::vector<unsigned> lod = simplifier.simplify(prev / 2);
+      // a level that barely shrank (locked borders) isn't worth keeping
+      if (lod.size() / 3 > prev * 3 / 4)
+        break;
+      s.lodIndexCount[l] = std::uint32_t(lod.size());
+      out.insert(out.end(), lod.begin(), lod.end());
+      prev = lod.size() / 3;
+    }
+
+    s.firstIndex = first;
+    s.indexCount = std::uint32_t(out.size()) - first;
+  }
+  indices = std::move(out);
+}
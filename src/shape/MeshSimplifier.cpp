@@ -0,0 +1,230 @@
+#include "shape/MeshSimplifier.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
+
+void MeshSimplifier::Quadric::addPlane(const glm::dvec3 &n, double d,
+                                       double w) {
+  const double p[4] = {n.x, n.y, n.z, d};
+  for (int r = 0, k = 0; r < 4; ++r)
+    for (int c = r; c < 4; ++c)
+      a[k++] += w * p[r] * p[c];
+}
+
+MeshSimplifier::Quadric &
+MeshSimplifier::Quadric::operator+=(const Quadric &q) {
+  for (int i = 0; i < 10; ++i)
+    a[i] += q.a[i];
+  return *this;
+}
+
+double MeshSimplifier::Quadric::error(const glm::vec3 &v) const {
+  const double p[4] = {v.x, v.y, v.z, 1.0};
+  double e = 0.0;
+  for (int r = 0, k = 0; r < 4; ++r)
+    for (int c = r; c < 4; ++c)
+      e += (r == c ? 1.0 : 2.0) * a[k++] * p[r] * p[c];
+  return std::max(e, 0.0);
+}
+
+MeshSimplifier::MeshSimplifier(const Vertex *vertices,
+                               std::size_t vertexCount,
+                               const unsigned *indices,
+                               std::size_t indexCount)
+    : verts(vertices), remap(vertexCount), group(vertexCount) {
+  // weld by exact position
+  std::map<std::tuple<float, float, float>, unsigned> byPos;
+  for (unsigned v = 0; v < vertexCount; ++v) {
+    const glm::vec3 &p = verts[v].pos;
+    auto [it, added] =
+        byPos.emplace(std::make_tuple(p.x, p.y, p.z), unsigned(pos.size()));
+    if (added) {
+      pos.push_back(p);
+      members.emplace_back();
+    }
+    group[v] = it->second;
+    members[it->second].push_back(v);
+    remap[v] = v;
+  }
+
+  const std::size_t groups = pos.size();
+  faces.resize(groups);
+  quadric.resize(groups);
+  stamp.assign(groups, 0);
+  locked.assign(groups, 0);
+  gone.assign(groups, 0);
+
+  // every face adds its plane, weighted by area, to its corners
+  std::map<std::pair<unsigned, unsigned>, int> edgeUse;
+  for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+    std::array<unsigned, 3> t{indices[i], indices[i + 1], indices[i + 2]};
+    const unsigned g[3] = {group[t[0]], group[t[1]], group[t[2]]};
+    if (g[0] == g[1] || g[1] == g[2] || g[0] == g[2])
+      continue;
+
+    glm::dvec3 p0(pos[g[0]]), p1(pos[g[1]]), p2(pos[g[2]]);
+    glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+    const double len = glm::length(n);
+    if (len > 0.0) {
+      n /= len;
+      for (unsigned c : g)
+        quadric[c].addPlane(n, -glm::dot(n, p0), 0.5 * len);
+    }
+
+    const unsigned id = unsigned(tris.size());
+    tris.push_back(t);
+    for (int c = 0; c < 3; ++c) {
+      faces[g[c]].push_back(id);
+      auto e = std::minmax(g[c], g[(c + 1) % 3]);
+      ++edgeUse[{e.first, e.second}];
+    }
+  }
+  alive = tris.size();
+
+  // an edge with one face is on an open border: both ends stay put
+  for (const auto &[e, uses] : edgeUse)
+    if (uses == 1)
+      locked[e.first] = locked[e.second] = 1;
+
+  for (unsigned g = 0; g < groups; ++g)
+    pushBest(g);
+}
+
+unsigned MeshSimplifier::resolve(unsigned v) {
+  unsigned r = v;
+  while (remap[r] != r)
+    r = remap[r];
+  while (remap[v] != r) // path compression
+    v = std::exchange(remap[v], r);
+  return r;
+}
+
+bool MeshSimplifier::triAlive(unsigned t) {
+  const unsigned a = groupOf(tris[t][0]), b = groupOf(tris[t][1]),
+                 c = groupOf(tris[t][2]);
+  return a != b && b != c && a != c;
+}
+
+bool MeshSimplifier::contains(unsigned t, unsigned g) {
+  for (unsigned v : tris[t])
+    if (groupOf(v) == g)
+      return true;
+  return false;
+}
+
+std::vector<unsigned> MeshSimplifier::neighbours(unsigned g) {
+  std::vector<unsigned> out;
+  for (unsigned t : faces[g]) {
+    if (!triAlive(t))
+      continue;
+    for (unsigned v : tris[t]) {
+      unsigned n = groupOf(v);
+      if (n != g && std::find(out.begin(), out.end(), n) == out.end())
+        out.push_back(n);
+    }
+  }
+  return out;
+}
+
+// no face around <from> may turn over (or collapse to a sliver) when <from>
+// moves onto <to>
+bool MeshSimplifier::canCollapse(unsigned from, unsigned to) {
+  for (unsigned t : faces[from]) {
+    if (!triAlive(t) || contains(t, to))
+      continue;
+    glm::vec3 p[3], q[3];
+    for (int c = 0; c < 3; ++c) {
+      const unsigned g = groupOf(tris[t][c]);
+      p[c] = pos[g];
+      q[c] = g == from ? pos[to] : pos[g];
+    }
+    const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+    const glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+    if (glm::dot(before, after) <= 0.05f * glm::length(before) *
+                                       glm::length(after) ||
+        glm::length(after) == 0.f)
+      return false;
+  }
+  return true;
+}
+
+void MeshSimplifier::pushBest(unsigned g) {
+  if (locked[g] || gone[g])
+    return;
+  double best = std::numeric_limits<double>::max();
+  unsigned target = g;
+  for (unsigned n : neighbours(g)) {
+    // the merged corner sits at <n>, so only <g>'s own planes add error
+    const double cost = quadric[g].error(pos[n]);
+    if (cost < best && canCollapse(g, n)) {
+      best = cost;
+      target = n;
+    }
+  }
+  if (target != g)
+    heap.push({best, g, target, stamp[g]});
+}
+
+void MeshSimplifier::collapse(unsigned from, unsigned to) {
+  // each vertex goes to the one at the target with the closest attributes
+  for (unsigned v : members[from]) {
+    unsigned pick = members[to].front();
+    float bestDiff = std::numeric_limits<float>::max();
+    for (unsigned w : members[to]) {
+      const glm::vec3 dn = verts[v].normal - verts[w].normal;
+      const glm::vec2 dt = verts[v].tex - verts[w].tex;
+      const float diff = glm::dot(dn, dn) + glm::dot(dt, dt);
+      if (diff < bestDiff) {
+        bestDiff = diff;
+        pick = w;
+      }
+    }
+    remap[v] = resolve(pick);
+  }
+
+  // faces on the collapsed edge are gone; the rest now belong to <to>
+  auto &list = faces[to];
+  list.insert(list.end(), faces[from].begin(), faces[from].end());
+  list.erase(std::remove_if(list.begin(), list.end(),
+                            [this](unsigned t) { return !triAlive(t); }),
+             list.end());
+  std::sort(list.begin(), list.end());
+  list.erase(std::unique(list.begin(), list.end()), list.end());
+  faces[from] = {};
+  gone[from] = 1;
+  quadric[to] += quadric[from];
+
+  ++stamp[to];
+  pushBest(to);
+  for (unsigned n : neighbours(to)) {
+    ++stamp[n];
+    pushBest(n);
+  }
+}
+
+std::vector<unsigned> MeshSimplifier::simplify(std::size_t target) {
+  while (alive > target && !heap.empty()) {
+    const Collapse c = heap.top();
+    heap.pop();
+    if (gone[c.from] || gone[c.to] || c.stamp != stamp[c.from] ||
+        !canCollapse(c.from, c.to))
+      continue;
+
+    std::size_t dying = 0;
+    for (unsigned t : faces[c.from])
+      if (triAlive(t) && contains(t, c.to))
+        ++dying;
+    collapse(c.from, c.to);
+    alive -= dying;
+  }
+
+  std::vector<unsigned> out;
+  out.reserve(alive * 3);
+  for (unsigned t = 0; t < tris.size(); ++t)
+    if (triAlive(t))
+      for (unsigned v : tris[t])
+        out.push_back(resolve(v));
+  return out;
+}
@@ -1,61 +1,62 @@
 #include "shape/ModelShape.h"
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <iostream>
-#include <stdexcept>
+#include "render/DrawList.h"
+#include "util/GLState.h"
+#include "util/ResourceCache.h"
+#include <algorithm>
+#include <cmath>
 
 ModelShape::ModelShape(Shader *sh, const std::string &path, const glm::mat4 &m)
-    : modelMat(m), shader(sh) {
-  Assimp::Importer imp;
-  const aiScene *sc =
-      imp.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                             aiProcess_CalcTangentSpace);
-  if (!sc || sc->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !sc->mRootNode)
-    throw std::runtime_error("Assimp: " + std::string(imp.GetErrorString()));
-
-  loadNode(sc->mRootNode, sc, sh);
+    : ModelShape(sh, ResourceCache::inst().mesh(path), m) {}
+
+ModelShape::ModelShape(Shader *sh, std::shared_ptr<const MeshAsset> a,
+                       const glm::mat4 &m)
+    : asset(std::move(a)), modelMat(m), shader(sh) {
+  uModel = sh->uniform<glm::mat4>("model");
+  worldBounds = asset->bounds().transformed(modelMat);
 }
 
-void ModelShape::loadNode(const aiNode *node, const aiScene *scene,
-                          Shader *sh) {
-  for (unsigned i = 0; i < node->mNumMeshes; i++) {
-    const aiMesh *m = scene->mMeshes[node->mMeshes[i]];
-    std::vector<Vertex> v(m->mNumVertices);
-    for (unsigned k = 0; k < m->mNumVertices; k++) {
-      v[k].pos = {m->mVertices[k].x, m->mVertices[k].y, m->mVertices[k].z};
-      v[k].normal = {m->mNormals[k].x, m->mNormals[k].y, m->mNormals[k].z};
-      if (m->mTextureCoords[0])
-        v[k].tex = {m->mTextureCoords[0][k].x, m->mTextureCoords[0][k].y};
-    }
-    std::vector<unsigned> ind;
-    for (unsigned f = 0; f < m->mNumFaces; ++f) {
-      auto &face = m->mFaces[f];
-      ind.insert(ind.end(), face.mIndices, face.mIndices + face.mNumIndices);
-    }
-    meshes.emplace_back(
-        std::make_unique<Mesh>(sh, std::move(v), std::move(ind)));
+void ModelShape::render() {
+  if (asset->meshes().empty())
+    return;
+
+  shader->use();
+  shader->set(uModel, modelMat);
+
+  for (auto &m : asset->meshes()) {
+    GLState::inst().bindVertexArray(m->vertexArray());
+    m->draw();
   }
-  for (unsigned c = 0; c < node->mNumChildren; ++c)
-    loadNode(node->mChildren[c], scene, sh);
 }
 
-void ModelShape::setViewProj(const glm::mat4 &v, const glm::mat4 &p,
-                             const glm::vec3 &e) {
-  view = v;
-  proj = p;
-  eye = e;
+int ModelShape::detailFor(float pixels) const {
+  if (!(pixels < kFullDetailPixels)) // also off / unknown (infinite)
+    return 0;
+  const int lod = int(std::log2(kFullDetailPixels / std::max(pixels, 1.f)));
+  return std::min(lod, asset->lodCount() - 1);
 }
 
-void ModelShape::render() {
-  if (meshes.empty())
-    return;
+void ModelShape::emit(DrawList &list) {
+  const int lod = detailFor(list.screenSize(worldBounds));
+  const auto &meshes = asset->meshes();
+  for (std::size_t i = 0; i < meshes.size(); ++i)
+    list.add(shader, GL_TEXTURE_2D, 0, meshes[i]->vertexArray(), this,
+             int(i) * MeshData::kMaxLods + lod, worldBounds,
+             meshes[i]->triangles(lod));
+}
 
-  shader->use();
-  shader->setMat4("model", modelMat);
-  shader->setMat4("view", view);
-  shader->setMat4("proj", proj);
-  shader->setVec3("viewPos", eye);
+void ModelShape::drawPart(int part) {
+  shader->set(uModel, modelMat);
+  asset->meshes()[part / MeshData::kMaxLods]->draw(part %
+                                                    MeshData::kMaxLods);
+}
 
-  for (auto &m : meshes)
-    m->render();
+bool ModelShape::collect(std::vector<StaticDraw> &out) const {
+  for (const auto &m : asset->meshes()) {
+    const GeometryBlock &g = m->block();
+    const Mesh::Lod &l = m->level(0);
+    out.push_back({shader, nullptr, g.vertexArray(), l.count,
+                   g.firstIndex() + GLuint(l.first), g.baseVertex(),
+                   modelMat, m->bounds().transformed(modelMat)});
+  }
+  return true;
 }
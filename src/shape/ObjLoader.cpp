@@ -0,0 +1,292 @@
+#include "shape/ObjLoader.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// a v/vt/vn reference: 1-based as written (0 = absent), or - for relative
+// ones, which can only be placed once every chunk is parsed - a 0-based
+// position in this chunk's own list (negative: in an earlier chunk)
+struct Ref {
+  std::int64_t idx[3] = {0, 0, 0}; // v, vt, vn
+  bool local[3] = {false, false, false};
+};
+
+// what one thread makes of its slice of the file
+struct Chunk {
+  std::vector<glm::vec3> positions, normals;
+  std::vector<glm::vec2> texcoords;
+  std::vector<Ref> corners; // three per triangle
+  // submesh boundaries: triangle index at which a new one starts
+  std::vector<std::size_t> breaks;
+};
+
+constexpr std::size_t kMinChunkBytes = 256 * 1024;
+
+const char *skipSpace(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t'))
+    ++p;
+  return p;
+}
+
+const char *lineEnd(const char *p, const char *end) {
+  while (p < end && *p != '\n')
+    ++p;
+  return p;
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// reads up to <N> floats; missing ones stay 0
+template <int N> void parseFloats(const char *p, const char *end, float *out) {
+  for (int i = 0; i < N; ++i) {
+    p = skipSpace(p, end);
+    auto r = std::from_chars(p, end, out[i]);
+    if (r.ec != std::errc())
+      return;
+    p = r.ptr;
+  }
+}
+
+// "a", "a/b", "a//c" or "a/b/c"
+const char *parseCorner(const char *p, const char *end, const Chunk &c,
+                        Ref &ref) {
+  auto index = [&](const char *&q, int slot, std::size_t count) {
+    std::int64_t i = 0;
+    auto r = std::from_chars(q, end, i);
+    if (r.ec != std::errc())
+      return false;
+    q = r.ptr;
+    ref.local[slot] = i < 0;
+    ref.idx[slot] = i < 0 ? std::int64_t(count) + i : i;
+    return true;
+  };
+  if (!index(p, 0, c.positions.size()))
+    return nullptr;
+  if (p < end && *p == '/') {
+    ++p;
+    if (p < end && *p != '/')
+      index(p, 1, c.texcoords.size());
+    if (p < end && *p == '/') {
+      ++p;
+      index(p, 2, c.normals.size());
+    }
+  }
+  return p;
+}
+
+void parseChunk(const char *p, const char *end, Chunk &c) {
+  std::vector<Ref> poly;
+  while (p < end) {
+    const char *eol = lineEnd(p, end);
+    const char *s = skipSpace(p, eol);
+    const std::size_t len = std::size_t(eol - s);
+
+    if (len > 2 && s[0] == 'v' && isSpace(s[1])) {
+      glm::vec3 v(0.f);
+      parseFloats<3>(s + 2, eol, &v.x);
+      c.positions.push_back(v);
+    } else if (len > 3 && s[0] == 'v' && s[1] == 't' && isSpace(s[2])) {
+      glm::vec2 t(0.f);
+      parseFloats<2>(s + 3, eol, &t.x);
+      c.texcoords.push_back(t);
+    } else if (len > 3 && s[0] == 'v' && s[1] == 'n' && isSpace(s[2])) {
+      glm::vec3 n(0.f);
+      parseFloats<3>(s + 3, eol, &n.x);
+      c.normals.push_back(n);
+    } else if (len > 2 && s[0] == 'f' && isSpace(s[1])) {
+      poly.clear();
+      const char *q = s + 2;
+      for (;;) {
+        q = skipSpace(q, eol);
+        if (q >= eol || *q == '\r')
+          break;
+        Ref r;
+        const char *next = parseCorner(q, eol, c, r);
+        if (!next)
+          break;
+        poly.push_back(r);
+        q = next;
+        while (q < eol && !isSpace(*q))
+          ++q;
+      }
+      for (std::size_t k = 2; k < poly.size(); ++k) {
+        c.corners.push_back(poly[0]);
+        c.corners.push_back(poly[k - 1]);
+        c.corners.push_back(poly[k]);
+      }
+    } else if ((len > 1 && (s[0] == 'o' || s[0] == 'g') && isSpace(s[1])) ||
+               (len > 6 && std::equal(s, s + 6, "usemtl") &&
+                isSpace(s[6]))) {
+      c.breaks.push_back(c.corners.size() / 3);
+    }
+    p = eol + 1;
+  }
+}
+
+// 0-based index into the stitched list, or -1 when absent / out of range
+std::int64_t resolve(const Ref &r, int slot, std::size_t chunkBase,
+                     std::size_t total) {
+  std::int64_t i;
+  if (r.local[slot])
+    i = std::int64_t(chunkBase) + r.idx[slot];
+  else if (r.idx[slot] > 0)
+    i = r.idx[slot] - 1;
+  else
+    return -1;
+  return i >= 0 && std::size_t(i) < total ? i : -1;
+}
+
+struct CornerKey {
+  std::int64_t v, t, n;
+  bool operator==(const CornerKey &o) const {
+    return v == o.v && t == o.t && n == o.n;
+  }
+};
+struct CornerHash {
+  std::size_t operator()(const CornerKey &k) const {
+    std::uint64_t h = std::uint64_t(k.v) * 0x9E3779B97F4A7C15ull;
+    h ^= std::uint64_t(k.t) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= std::uint64_t(k.n) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+    return std::size_t(h);
+  }
+};
+
+} // namespace
+
+MeshData ObjLoader::load(const std::string &path) {
+  MappedFile file(path);
+  if (!file)
+    throw std::runtime_error("OBJ: can't read " + path);
+  file.adviseSequential();
+  const char *begin = reinterpret_cast<const char *>(file.data());
+  const char *end = begin + file.size();
+
+  // 1. line-aligned slices, one per thread (small files stay on this one)
+  const std::size_t threads = std::max<std::size_t>(
+      1, std::min<std::size_t>(std::thread::hardware_concurrency(),
+                               file.size() / kMinChunkBytes));
+  std::vector<const char *> cuts{begin};
+  for (std::size_t i = 1; i < threads; ++i) {
+    const char *p = std::max(cuts.back(), begin + file.size() * i / threads);
+    p = lineEnd(p, end);
+    cuts.push_back(p < end ? p + 1 : end);
+  }
+  cuts.push_back(end);
+
+  std::vector<Chunk> chunks(threads);
+  {
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i)
+      workers.emplace_back(parseChunk, cuts[i], cuts[i + 1],
+                           std::ref(chunks[i]));
+    parseChunk(cuts[0], cuts[1], chunks[0]);
+    for (std::thread &t : workers)
+      t.join();
+  }
+
+  // 2. stitch: global attribute lists and every triangle's resolved corners
+  std::vector<glm::vec3> positions, normals;
+  std::vector<glm::vec2> texcoords;
+  std::vector<CornerKey> corners;
+  std::vector<std::size_t> breaks;
+  std::size_t triangles = 0;
+  for (const Chunk &c : chunks) {
+    positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+    texcoords.insert(texcoords.end(), c.texcoords.begin(), c.texcoords.end());
+    normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+    for (std::size_t b : c.breaks)
+      breaks.push_back(triangles + b);
+    triangles += c.corners.size() / 3;
+  }
+  // absolute refs may point past their own chunk, so resolve once all are in
+  std::size_t vBase = 0, tBase = 0, nBase = 0;
+  corners.reserve(triangles * 3);
+  for (const Chunk &c : chunks) {
+    for (const Ref &r : c.corners)
+      corners.push_back({resolve(r, 0, vBase, positions.size()),
+                         resolve(r, 1, tBase, texcoords.size()),
+                         resolve(r, 2, nBase, normals.size())});
+    vBase += c.positions.size();
+    tBase += c.texcoords.size();
+    nBase += c.normals.size();
+  }
+
+  // 3. smooth normals where the file has none: area-weighted face normals
+  //    summed per position
+  std::vector<glm::vec3> smooth;
+  const bool needSmooth = std::any_of(
+      corners.begin(), corners.end(),
+      [](const CornerKey &k) { return k.n < 0 && k.v >= 0; });
+  if (needSmooth) {
+    smooth.assign(positions.size(), glm::vec3(0.f));
+    for (std::size_t i = 0; i + 2 < corners.size(); i += 3) {
+      const std::int64_t a = corners[i].v, b = corners[i + 1].v,
+                         c = corners[i + 2].v;
+      if (a < 0 || b < 0 || c < 0)
+        continue;
+      const glm::vec3 n = glm::cross(positions[b] - positions[a],
+                                     positions[c] - positions[a]);
+      smooth[a] += n;
+      smooth[b] += n;
+      smooth[c] += n;
+    }
+    for (glm::vec3 &n : smooth) {
+      const float l = glm::length(n);
+      n = l > 0.f ? n / l : glm::vec3(0.f, 1.f, 0.f);
+    }
+  }
+
+  // 4. one submesh per run between breaks; identical corners share a vertex
+  MeshData out;
+  out.vertices.reserve(positions.size());
+  out.indices.reserve(corners.size());
+  breaks.push_back(corners.size() / 3);
+  std::unordered_map<CornerKey, unsigned, CornerHash> seen;
+  std::size_t tri = 0;
+  for (std::size_t stop : breaks) {
+    if (stop <= tri)
+      continue;
+    MeshData::Submesh sub;
+    sub.firstVertex = std::uint32_t(out.vertices.size());
+    sub.firstIndex = std::uint32_t(out.indices.size());
+    seen.clear();
+
+    for (; tri < stop; ++tri) {
+      const CornerKey *k = &corners[tri * 3];
+      if (k[0].v < 0 || k[1].v < 0 || k[2].v < 0)
+        continue; // broken reference: drop the triangle
+      for (int c = 0; c < 3; ++c) {
+        auto [it, added] = seen.emplace(
+            k[c], unsigned(out.vertices.size() - sub.firstVertex));
+        if (added) {
+          Vertex v{};
+          v.pos = positions[k[c].v];
+          v.normal = k[c].n >= 0 ? normals[k[c].n] : smooth[k[c].v];
+          if (k[c].t >= 0)
+            v.tex = texcoords[k[c].t];
+          sub.bounds.expand(v.pos);
+          out.vertices.push_back(v);
+        }
+        out.indices.push_back(it->second);
+      }
+    }
+
+    sub.vertexCount = std::uint32_t(out.vertices.size()) - sub.firstVertex;
+    sub.indexCount = std::uint32_t(out.indices.size()) - sub.firstIndex;
+    if (sub.indexCount == 0)
+      continue;
+    out.bounds.expand(sub.bounds);
+    out.submeshes.push_back(sub);
+  }
+
+  if (out.submeshes.empty())
+    throw std::runtime_error("OBJ: no faces in " + path);
+  return out;
+}
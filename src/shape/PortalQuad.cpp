@@ -1,6 +1,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
 #include "shape/PortalQuad.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 #include <glad/glad.h>
 #include <glm/gtx/compatibility.hpp>
@@ -10,13 +11,12 @@
 // — Constructor —//
 PortalQuad::PortalQuad(Shader *sh, const glm::vec3 &P, const glm::vec3 &N_,
                        float sx, float sy)
-    : GLShape(sh), halfW(sx), halfH(sy) {
+    : GLShape(sh, false), halfW(sx), halfH(sy) {
   // 1) build a simple quad in +XY plane, centered at origin:
-  float verts[6 * 3] = {
-      -sx, -sy, 0.0f, sx, -sy, 0.0f, sx,  sy, 0.0f,
-
-      -sx, -sy, 0.0f, sx, sy,  0.0f, -sx, sy, 0.0f,
+  const float verts[4 * 3] = {
+      -sx, -sy, 0.0f, sx, -sy, 0.0f, sx, sy, 0.0f, -sx, sy, 0.0f,
   };
+  const unsigned indices[6] = {0, 1, 2, 0, 2, 3};
 
   // 2) build a stable orthonormal basis: R (right), U (up), N (normal)
   glm::vec3 N = glm::normalize(N_);
@@ -35,27 +35,24 @@ PortalQuad::PortalQuad(Shader *sh, const glm::vec3 &P, const glm::vec3 &N_,
   modelMat = glm::translate(glm::mat4(1.0f), P) * basis;
 
   // 5) upload the vertex data
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-  glEnableVertexAttribArray(0);
-  glBindVertexArray(0);
+  geometry = GeometryArena::inst().allocate(VertexFormat::P3, verts, 4,
+                                            indices, 6);
+
+  // 6) uniform handles for render()
+  uModel = sh->uniform<glm::mat4>("uModel");
+  uPortalVP = sh->uniform<glm::mat4>("uPortalVP");
 }
 
 // — Render the portal quad (with debug‐coloring) —//
 void PortalQuad::render() {
   pShader->use();
 
-  pShader->setMat4("uModel", modelMat);
-  pShader->setMat4("uView", view);
-  pShader->setMat4("uProj", proj);
+  pShader->set(uModel, modelMat);
 
-  pShader->setMat4("uPortalVP", portalVP);
+  pShader->set(uPortalVP, portalVP);
 
-  glBindVertexArray(vao);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
+  GLState::inst().bindVertexArray(geometry.vertexArray());
+  geometry.draw();
 }
 
 // — World‐space center point —//
@@ -1,6 +1,25 @@
 /// STOP. You should not modify this file unless you KNOW what you are doing.
 
 #include "shape/Renderable.h"
+#include "render/DrawList.h"
 
 
 Renderable::~Renderable() noexcept = default;
+
+
+Bounds Renderable::bounds() const
+{
+    return {};
+}
+
+
+void Renderable::emit(DrawList & list)
+{
+    list.addOpaque(this, bounds());
+}
+
+
+void Renderable::drawPart(int)
+{
+    render();
+}
@@ -1,8 +1,14 @@
 #include "glad/glad.h"
 
 #define STB_IMAGE_IMPLEMENTATION
+#include "shape/DdsImage.h"
 #include "shape/Texture.h"
+#include "shape/TextureStreamer.h"
+#include "util/GLState.h"
 #include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <iostream> // optional: for error/debug prints
 #include <stb_image.h>
 #include <stdexcept>
@@ -27,15 +33,74 @@ void Texture2D::upload() const {
   if (!data)
     throw std::runtime_error("Texture load failed: " + file);
 
-  GLenum fmt = (n == 3) ? GL_RGB : GL_RGBA;
+  create(w, h, (n == 3) ? GL_RGB : GL_RGBA, data);
 
+  stbi_image_free(data);
+}
+
+void Texture2D::create(int w, int h, GLenum fmt, const void *pixels) const {
   glGenTextures(1, &id);
-  glBindTexture(GL_TEXTURE_2D, id);
+  GLState::inst().bindTexture(GL_TEXTURE_2D, id);
 
-  glTexImage2D(GL_TEXTURE_2D, 0, fmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, data);
+  glTexImage2D(GL_TEXTURE_2D, 0, fmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, pixels);
 
   glGenerateMipmap(GL_TEXTURE_2D);
+  setSampling();
+
+  // drivers keep 3-channel textures as RGBA too; a full chain adds a third
+  vramBytes = rawBytes = std::size_t(w) * h * 4 * 4 / 3;
+}
+
+bool Texture2D::uploadCompressed(const std::string &ddsPath) {
+  DdsImage dds(ddsPath);
+  if (!dds)
+    return false;
+
+  GLenum fmt;
+  switch (dds.format()) {
+  case DdsImage::Format::BC1:
+    // S3TC is an extension in every core version
+    if (!GLAD_GL_EXT_texture_compression_s3tc)
+      return false;
+    fmt = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    break;
+  case DdsImage::Format::BC3:
+    if (!GLAD_GL_EXT_texture_compression_s3tc)
+      return false;
+    fmt = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    break;
+  case DdsImage::Format::BC7:
+    // core only from 4.2; the demo asks for a 3.3 context
+    if (!GLAD_GL_ARB_texture_compression_bptc)
+      return false;
+    fmt = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+    break;
+  default:
+    return false;
+  }
+
+  if (id)
+    GLState::inst().deleteTextures(1, &id);
+  glGenTextures(1, &id);
+  GLState::inst().bindTexture(GL_TEXTURE_2D, id);
+
+  vramBytes = rawBytes = 0;
+  for (int i = 0; i < dds.levelCount(); ++i) {
+    const DdsImage::Level &l = dds.level(i);
+    glCompressedTexImage2D(GL_TEXTURE_2D, i, fmt, l.width, l.height, 0,
+                           GLsizei(l.size), l.data);
+    vramBytes += l.size;
+    rawBytes += std::size_t(l.width) * l.height * 4;
+  }
+  // the chain may stop short of 1×1; sample only what the file has
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, dds.levelCount() - 1);
+  setSampling();
+
+  isCompressed = true;
+  return true;
+}
 
+void Texture2D::setSampling() const {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
                   GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -46,6 +111,173 @@ void Texture2D::upload() const {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   }
+}
 
-  stbi_image_free(data);
+GLuint Texture2D::placeholder() {
+  static GLuint tex = [] {
+    const unsigned char white[4] = {255, 255, 255, 255};
+    GLuint t;
+    glGenTextures(1, &t);
+    GLState::inst().bindTexture(GL_TEXTURE_2D, t);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return t;
+  }();
+  return tex;
+}
+
+Texture2DArray::Texture2DArray(const std::vector<std::string> &paths,
+                               int layerSize)
+    : layerCount(int(paths.size())) {
+  glGenTextures(1, &id);
+  GLState::inst().bindTexture(GL_TEXTURE_2D_ARRAY, id);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerSize, layerSize,
+               layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+  // each image goes up as a plain 2D texture and is blitted (and so scaled)
+  // into its layer
+  GLint prevFbo = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+  GLuint fbos[2];
+  glGenFramebuffers(2, fbos);
+
+  // all layers decode in parallel on the streamer's pool
+  std::vector<std::future<DecodedImage>> decoded;
+  for (const std::string &p : paths)
+    decoded.push_back(TextureStreamer::inst().decode(p));
+
+  for (int i = 0; i < layerCount; ++i) {
+    DecodedImage img = decoded[i].get();
+    if (!img.pixels)
+      throw std::runtime_error("Texture load failed: " + paths[i]);
+    const int w = img.width, h = img.height;
+
+    GLuint src;
+    glGenTextures(1, &src);
+    GLState::inst().bindTexture(GL_TEXTURE_2D, src);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, img.pixels.get());
+
+    GLState::inst().bindFramebuffer(GL_READ_FRAMEBUFFER, fbos[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, src, 0);
+    GLState::inst().bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[1]);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, id, 0,
+                              i);
+    glBlitFramebuffer(0, 0, w, h, 0, 0, layerSize, layerSize,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    GLState::inst().deleteTextures(1, &src);
+  }
+
+  GLState::inst().bindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+  GLState::inst().deleteFramebuffers(2, fbos);
+
+  GLState::inst().bindTexture(GL_TEXTURE_2D_ARRAY, id);
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+TextureCube::TextureCube(const std::array<std::string, 6> &faces) {
+  std::array<std::future<DecodedImage>, 6> decoded;
+  for (int i = 0; i < 6; ++i)
+    decoded[i] = TextureStreamer::inst().decode(faces[i]);
+
+  glGenTextures(1, &id);
+  GLState::inst().bindTexture(GL_TEXTURE_CUBE_MAP, id);
+  for (int i = 0; i < 6; ++i) {
+    DecodedImage img = decoded[i].get();
+    if (!img.pixels)
+      throw std::runtime_error("Texture load failed: " + faces[i]);
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, img.width,
+                 img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.pixels.get());
+  }
+  finish();
+}
+
+// Converts a direction vector to equirectangular UV coordinates
+static glm::vec2 dirToEquirectUV(const glm::vec3 &dir) {
+  glm::vec3 n = glm::normalize(dir);
+
+  float u = 0.5f + atan2(n.z, n.x) / (2.0f * glm::pi<float>()); // z before x
+
+  float v = 0.5f - asin(n.y) / glm::pi<float>();
+  return {u, v};
+}
+
+// direction through texel (s, t) ∈ [-1, 1]² of cube face <face>, following
+// the GL face orientation table (t grows downwards)
+static glm::vec3 cubeFaceDir(int face, float s, float t) {
+  switch (face) {
+  case 0:
+    return {1, -t, -s};
+  case 1:
+    return {-1, -t, s};
+  case 2:
+    return {s, 1, t};
+  case 3:
+    return {s, -1, -t};
+  case 4:
+    return {s, -t, 1};
+  default:
+    return {-s, -t, -1};
+  }
+}
+
+TextureCube::TextureCube(const std::string &equirect, int faceSize) {
+  int w, h, n;
+  stbi_uc *src = stbi_load(equirect.c_str(), &w, &h, &n, 4);
+  if (!src)
+    throw std::runtime_error("Texture load failed: " + equirect);
+
+  // bilinear fetch; u wraps around the seam, v clamps at the poles
+  auto texel = [&](int x, int y) {
+    x = (x % w + w) % w;
+    y = std::clamp(y, 0, h - 1);
+    const stbi_uc *p = src + 4 * (std::size_t(y) * w + x);
+    return glm::vec4(p[0], p[1], p[2], p[3]);
+  };
+  auto sample = [&](glm::vec2 uv) {
+    float x = uv.x * w - 0.5f, y = uv.y * h - 0.5f;
+    int x0 = int(std::floor(x)), y0 = int(std::floor(y));
+    float fx = x - x0, fy = y - y0;
+    glm::vec4 top = glm::mix(texel(x0, y0), texel(x0 + 1, y0), fx);
+    glm::vec4 bot = glm::mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx);
+    return glm::mix(top, bot, fy);
+  };
+
+  glGenTextures(1, &id);
+  GLState::inst().bindTexture(GL_TEXTURE_CUBE_MAP, id);
+  std::vector<stbi_uc> face(std::size_t(faceSize) * faceSize * 4);
+  for (int f = 0; f < 6; ++f) {
+    stbi_uc *out = face.data();
+    for (int y = 0; y < faceSize; ++y)
+      for (int x = 0; x < faceSize; ++x) {
+        float s = 2.f * (x + 0.5f) / faceSize - 1.f;
+        float t = 2.f * (y + 0.5f) / faceSize - 1.f;
+        glm::vec4 c = sample(dirToEquirectUV(cubeFaceDir(f, s, t)));
+        for (int k = 0; k < 4; ++k)
+          *out++ = stbi_uc(c[k] + 0.5f);
+      }
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_RGBA8, faceSize,
+                 faceSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, face.data());
+  }
+  stbi_image_free(src);
+  finish();
+}
+
+void TextureCube::finish() {
+  glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 }
@@ -0,0 +1,134 @@
+#include "shape/TextureStreamer.h"
+#include "shape/Texture.h"
+#include <algorithm>
+#include <cstring>
+#include <stb_image.h>
+#include <stdexcept>
+
+static DecodedImage decodeFile(const std::string &path) {
+  DecodedImage img;
+  int n;
+  stbi_uc *data = stbi_load(path.c_str(), &img.width, &img.height, &n, 4);
+  if (data)
+    img.pixels.reset(data, stbi_image_free);
+  return img;
+}
+
+TextureStreamer::TextureStreamer() {
+  // leave one core to the render loop
+  unsigned n = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  for (unsigned i = 0; i < n; ++i)
+    workers.emplace_back([this] { work(); });
+}
+
+TextureStreamer::~TextureStreamer() {
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    stopping = true;
+  }
+  jobReady.notify_all();
+  for (std::thread &t : workers)
+    t.join();
+  if (pbos[0])
+    glDeleteBuffers(kRing, pbos.data());
+}
+
+void TextureStreamer::submit(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    jobs.push_back(std::move(job));
+  }
+  jobReady.notify_one();
+}
+
+void TextureStreamer::work() {
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(jobMutex);
+      jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (stopping)
+        return;
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    job();
+  }
+}
+
+void TextureStreamer::request(const std::shared_ptr<Texture2D> &tex) {
+  tex->streamed = true;
+  ++pending;
+  std::weak_ptr<Texture2D> weak = tex;
+  std::string path = tex->path();
+  submit([this, weak, path] {
+    Ready r{weak, path, decodeFile(path)};
+    std::lock_guard<std::mutex> lock(readyMutex);
+    ready.push_back(std::move(r));
+  });
+}
+
+std::future<DecodedImage> TextureStreamer::decode(const std::string &path) {
+  // std::function wants a copyable callable, so the task is shared
+  auto task = std::make_shared<std::packaged_task<DecodedImage()>>(
+      [path] { return decodeFile(path); });
+  std::future<DecodedImage> result = task->get_future();
+  submit([task] { (*task)(); });
+  return result;
+}
+
+void TextureStreamer::pump() {
+  stats = {};
+  for (;;) {
+    Ready r;
+    {
+      std::lock_guard<std::mutex> lock(readyMutex);
+      if (ready.empty())
+        break;
+      // the first image always goes, however big
+      if (stats.uploaded > 0 &&
+          stats.bytes + ready.front().image.bytes() > frameBudget)
+        break;
+      r = std::move(ready.front());
+      ready.pop_front();
+    }
+    --pending;
+
+    std::shared_ptr<Texture2D> tex = r.texture.lock();
+    if (!tex) // released while it was decoding
+      continue;
+    if (!r.image.pixels)
+      throw std::runtime_error("Texture load failed: " + r.path);
+
+    upload(*tex, r.image);
+    ++stats.uploaded;
+    stats.bytes += r.image.bytes();
+  }
+  stats.pending = pending;
+}
+
+void TextureStreamer::upload(Texture2D &tex, const DecodedImage &img) {
+  if (!pbos[0])
+    glGenBuffers(kRing, pbos.data());
+
+  // cycling through a few buffers (and orphaning each one) means the copy
+  // never waits for the driver to finish reading the previous upload
+  const std::size_t bytes = img.bytes();
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+  nextPbo = (nextPbo + 1) % kRing;
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(bytes), nullptr,
+               GL_STREAM_DRAW);
+  void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(bytes),
+                               GL_MAP_WRITE_BIT |
+                                   GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (dst) {
+    std::memcpy(dst, img.pixels.get(), bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    tex.create(img.width, img.height, GL_RGBA, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  } else {
+    // mapping failed: plain client-memory upload
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    tex.create(img.width, img.height, GL_RGBA, img.pixels.get());
+  }
+}
@@ -29,12 +29,27 @@ TexturedBox::TexturedBox(Shader *sh, const glm::vec3 &C, float W, float H,
                                             glm::vec3(0, 0, +1), W / 2, H / 2,
                                             tex, glm::mat4(1.f), tile);
 }
+
+Bounds TexturedBox::bounds() const {
+  Bounds b;
+  for (auto &f : faces)
+    b.expand(f->bounds());
+  return b;
+}
+
+void TexturedBox::emit(DrawList &list) {
+  for (auto &f : faces)
+    f->emit(list);
+}
+
+bool TexturedBox::collect(std::vector<StaticDraw> &out) const {
+  for (auto &f : faces)
+    if (!f->collect(out))
+      return false;
+  return true;
+}
+
 void TexturedBox::render() {
-  for (auto &f : faces) {
-    // Inherit view/proj from the box
-    if (auto *q = dynamic_cast<TexturedQuad *>(f.get())) {
-      q->setViewProj(view, proj);
-    }
+  for (auto &f : faces)
     f->render();
-  }
 }
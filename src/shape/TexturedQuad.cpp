@@ -1,6 +1,9 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
 #include "shape/TexturedQuad.h"
+#include "render/DrawList.h"
+#include "render/GeometryArena.h"
+#include "util/GLState.h"
 #include "util/Shader.h"
 #include <array>
 #include <glm/gtx/compatibility.hpp>
@@ -11,7 +14,10 @@ struct TVertex {
   glm::vec2 uv;
 };
 
-static std::array<TVertex, 6> buildQuad(const glm::vec3 &P, const glm::vec3 &N,
+// the two triangles of every quad, over its four corners
+static const unsigned kQuadIndices[6] = {0, 1, 2, 0, 2, 3};
+
+static std::array<TVertex, 4> buildQuad(const glm::vec3 &P, const glm::vec3 &N,
                                         float sx, float sy, bool tile) {
   glm::vec3 upHint =
       glm::abs(N.y) > 0.999f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
@@ -33,74 +39,95 @@ static std::array<TVertex, 6> buildQuad(const glm::vec3 &P, const glm::vec3 &N,
   float u1 = tile ? 2.f * sx : 1.f;
   float v1 = tile ? 2.f * sy : 1.f;
 
-  return {{{c0, {0, 0}},
-           {c1, {u1, 0}},
-           {c2, {u1, v1}},
-           {c0, {0, 0}},
-           {c2, {u1, v1}},
-           {c3, {0, v1}}}};
+  return {{{c0, {0, 0}}, {c1, {u1, 0}}, {c2, {u1, v1}}, {c3, {0, v1}}}};
+}
+
+static GeometryBlock uploadQuad(const std::array<TVertex, 4> &v) {
+  static_assert(sizeof(TVertex) == 5 * sizeof(float),
+                "TVertex must match VertexFormat::P3T2");
+  return GeometryArena::inst().allocate(VertexFormat::P3T2, v.data(),
+                                        v.size(), kQuadIndices, 6);
 }
 
 TexturedQuad::TexturedQuad(Shader *sh, const glm::vec3 &P, const glm::vec3 &N_,
                            float sx, float sy, std::shared_ptr<Texture2D> tex,
                            const glm::mat4 &M, bool tile)
-    : GLShape(sh), texture(std::move(tex)), modelMat(M), centre(P),
+    : GLShape(sh, false), texture(std::move(tex)), modelMat(M), centre(P),
       N(glm::normalize(N_)) {
   auto v = buildQuad(P, N, sx, sy, tile);
+  Bounds b;
+  for (const TVertex &vx : v)
+    b.expand(vx.pos);
+  setLocalBounds(b);
 
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(v), v.data(), GL_STATIC_DRAW);
+  geometry = uploadQuad(v);
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TVertex), (void *)0);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TVertex),
-                        (void *)offsetof(TVertex, uv));
-  glEnableVertexAttribArray(1);
-  glBindVertexArray(0);
+  resolveUniforms();
 }
 
 void TexturedQuad::render() {
   pShader->use();
-  pShader->setMat4("model", modelMat);
-  pShader->setMat4("view", view);
-  pShader->setMat4("proj", proj);
+  if (texture)
+    texture->bind(0);
 
+  GLState::inst().bindVertexArray(vertexArray());
+  drawPart(0);
+}
+
+void TexturedQuad::emit(DrawList &list) {
+  list.add(pShader, GL_TEXTURE_2D, texture ? texture->handle() : 0,
+           vertexArray(), this, 0, worldBounds);
+}
+
+void TexturedQuad::drawPart(int) {
+  pShader->set(uModel, modelMat);
   if (texture) {
-    texture->bind(0);
-    pShader->setInt("tex0", 0);
+    pShader->set(uTex0, 0);
   } else {
     // optional: set solid color fallback
-    pShader->setInt("tex0", -1);
+    pShader->set(uTex0, -1);
   }
 
-  glBindVertexArray(vao);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
+  if (geometry)
+    geometry.draw();
+  else // overrideVAO: six vertices of its own
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+bool TexturedQuad::collect(std::vector<StaticDraw> &out) const {
+  if (!geometry) // overrideVAO: not in the arena
+    return false;
+  out.push_back({pShader, texture, geometry.vertexArray(),
+                 geometry.indexCount(), geometry.firstIndex(),
+                 geometry.baseVertex(), modelMat, worldBounds});
+  return true;
 }
 
 TexturedQuad::TexturedQuad(Shader *sh, std::shared_ptr<Texture2D> tex,
                            const glm::mat4 &M)
-    : GLShape(sh), texture(std::move(tex)), modelMat(M) {
+    : GLShape(sh, false), texture(std::move(tex)), modelMat(M) {
   // nothing: will override VAO and bind their own vertex data
+  resolveUniforms();
+}
+
+void TexturedQuad::resolveUniforms() {
+  uModel = pShader->uniform<glm::mat4>("model");
+  uTex0 = pShader->uniform<GLint>("tex0");
 }
 
 TexturedQuad::TexturedQuad(Shader *sh, const glm::vec3 &P, const glm::vec3 &N_,
                            float sx, float sy, std::shared_ptr<Texture2D> tex,
                            const glm::mat4 &M)
-    : GLShape(sh), texture(std::move(tex)), modelMat(M), centre(P),
+    : GLShape(sh, false), texture(std::move(tex)), modelMat(M), centre(P),
       N(glm::normalize(N_)) {
   bool tile = false;
   auto v = buildQuad(P, N, sx, sy, tile);
+  Bounds b;
+  for (const TVertex &vx : v)
+    b.expand(vx.pos);
+  setLocalBounds(b);
 
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(v), v.data(), GL_STATIC_DRAW);
+  geometry = uploadQuad(v);
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TVertex), (void *)0);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TVertex),
-                        (void *)offsetof(TVertex, uv));
-  glEnableVertexAttribArray(1);
-  glBindVertexArray(0);
+  resolveUniforms();
 }
@@ -0,0 +1,44 @@
+// Offline mesh cooker. Imports each model exactly as the app would
+// (MeshData::import) and writes <model>.cmesh next to it (see
+// shape/CookedMesh.h); the app then maps that file instead of parsing the
+// model at start-up.
+//
+//   bin/meshcook rsrc/models/*.obj
+//   (or: cmake --build . --target cook_meshes)
+
+#include "shape/CookedMesh.h"
+#include "shape/MeshData.h"
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s model...\n", argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string path = argv[i];
+    try {
+      auto t0 = std::chrono::steady_clock::now();
+      MeshData data = MeshData::import(path);
+      double ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - t0)
+                      .count();
+      if (!CookedMesh::write(path, data, MeshData::kDefaultImport))
+        throw std::runtime_error("can't write " + CookedMesh::pathFor(path));
+
+      std::printf("%s: %zu submeshes, %zu vertices, %zu indices "
+                  "(import %.1f ms)\n",
+                  path.c_str(), data.submeshes.size(), data.vertices.size(),
+                  data.indices.size(), ms);
+    } catch (const std::exception &e) {
+      std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+      ++failed;
+    }
+  }
+  return failed ? 1 : 0;
+}
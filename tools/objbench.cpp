@@ -0,0 +1,65 @@
+// Times the native OBJ loader against the Assimp import it replaces, on the
+// same files and without the level-of-detail pass both are followed by.
+//
+//   bin/objbench [runs] model.obj...
+//   (or: cmake --build . --target bench_obj, on indoor plant_02.obj)
+
+#include "shape/MeshData.h"
+#include "shape/ObjLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+template <class Load> static double bestMs(int runs, Load load, MeshData &out) {
+  double best = 1e30;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    out = load();
+    best = std::min(best, std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - t0)
+                              .count());
+  }
+  return best;
+}
+
+static void report(const char *name, double ms, const MeshData &d) {
+  std::printf("  %-8s %8.1f ms  %zu submeshes, %zu vertices, %zu indices\n",
+              name, ms, d.submeshes.size(), d.vertices.size(),
+              d.indices.size());
+}
+
+int main(int argc, char **argv) {
+  int first = 1, runs = 5;
+  if (argc > 2 && std::atoi(argv[1]) > 0) {
+    runs = std::atoi(argv[1]);
+    first = 2;
+  }
+  if (first >= argc) {
+    std::fprintf(stderr, "usage: %s [runs] model.obj...\n", argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  for (int i = first; i < argc; ++i) {
+    const std::string path = argv[i];
+    std::printf("%s (best of %d)\n", path.c_str(), runs);
+    try {
+      MeshData native, assimp;
+      double nativeMs =
+          bestMs(runs, [&] { return ObjLoader::load(path); }, native);
+      double assimpMs =
+          bestMs(runs, [&] { return MeshData::importAssimp(path); }, assimp);
+      report("native", nativeMs, native);
+      report("assimp", assimpMs, assimp);
+      std::printf("  speed-up %.1fx\n", assimpMs / nativeMs);
+    } catch (const std::exception &e) {
+      std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+      ++failed;
+    }
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// Offline texture compressor. Decodes each image, builds its mip chain and
+// block-compresses every level with stb_dxt: BC1 when the image is opaque,
+// BC3 when it has alpha. The result goes to <image>.dds next to it (see
+// shape/DdsImage.h), which ResourceCache then uploads instead of the source.
+//
+//   bin/texcompress rsrc/textures/*.png rsrc/textures/*.jpg
+//   (or: cmake --build . --target compress_textures)
+//
+// BC7 files made by other tools load as well; this one doesn't write them.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+#include "shape/DdsImage.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Image {
+  int width, height;
+  std::vector<unsigned char> rgba;
+};
+
+// 2×2 box filter; an odd edge reuses its last row/column
+Image halve(const Image &src) {
+  Image dst{std::max(1, src.width / 2), std::max(1, src.height / 2), {}};
+  dst.rgba.resize(std::size_t(dst.width) * dst.height * 4);
+  for (int y = 0; y < dst.height; ++y)
+    for (int x = 0; x < dst.width; ++x)
+      for (int c = 0; c < 4; ++c) {
+        int sum = 0;
+        for (int dy = 0; dy < 2; ++dy)
+          for (int dx = 0; dx < 2; ++dx) {
+            int sx = std::min(2 * x + dx, src.width - 1);
+            int sy = std::min(2 * y + dy, src.height - 1);
+            sum += src.rgba[(std::size_t(sy) * src.width + sx) * 4 + c];
+          }
+        dst.rgba[(std::size_t(y) * dst.width + x) * 4 + c] =
+            static_cast<unsigned char>((sum + 2) / 4);
+      }
+  return dst;
+}
+
+std::vector<unsigned char> compress(const Image &img, DdsImage::Format f) {
+  const bool alpha = f == DdsImage::Format::BC3;
+  std::vector<unsigned char> out(
+      DdsImage::levelBytes(f, img.width, img.height));
+  unsigned char *dst = out.data();
+  unsigned char block[16 * 4];
+  for (int by = 0; by < img.height; by += 4)
+    for (int bx = 0; bx < img.width; bx += 4) {
+      // blocks past the edge repeat the last texel
+      for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x) {
+          int sx = std::min(bx + x, img.width - 1);
+          int sy = std::min(by + y, img.height - 1);
+          std::copy_n(&img.rgba[(std::size_t(sy) * img.width + sx) * 4], 4,
+                      &block[(y * 4 + x) * 4]);
+        }
+      stb_compress_dxt_block(dst, block, alpha, STB_DXT_HIGHQUAL);
+      dst += DdsImage::blockBytes(f);
+    }
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s image...\n", argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string path = argv[i];
+    Image img{};
+    int n;
+    stbi_uc *data = stbi_load(path.c_str(), &img.width, &img.height, &n, 4);
+    if (!data) {
+      std::fprintf(stderr, "%s: %s\n", path.c_str(), stbi_failure_reason());
+      ++failed;
+      continue;
+    }
+    img.rgba.assign(data, data + std::size_t(img.width) * img.height * 4);
+    stbi_image_free(data);
+
+    bool opaque = true;
+    for (std::size_t p = 3; p < img.rgba.size() && opaque; p += 4)
+      opaque = img.rgba[p] == 255;
+    const DdsImage::Format f =
+        opaque ? DdsImage::Format::BC1 : DdsImage::Format::BC3;
+
+    std::vector<std::vector<unsigned char>> levels;
+    std::size_t bytes = 0;
+    for (Image level = img;; level = halve(level)) {
+      levels.push_back(compress(level, f));
+      bytes += levels.back().size();
+      if (level.width == 1 && level.height == 1)
+        break;
+    }
+
+    const std::string out = DdsImage::pathFor(path);
+    if (!DdsImage::write(out, f, img.width, img.height, levels)) {
+      std::fprintf(stderr, "%s: can't write %s\n", path.c_str(), out.c_str());
+      ++failed;
+      continue;
+    }
+    std::printf("%s: %dx%d %s, %zu levels, %.1f KB\n", path.c_str(),
+                img.width, img.height, opaque ? "BC1" : "BC3", levels.size(),
+                bytes / 1024.0);
+  }
+  return failed ? 1 : 0;
+}